@@ -0,0 +1,120 @@
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+#include "FastNoise.h"
+#include "reference/FastNoiseReference.h"
+
+// Times FastNoise's 2D GetNoise() against the switching implementation it replaced, for every noise type,
+// fractal type, interpolation and a spread of octave counts, and checks every sample comes out identical
+// Configure with -DBUILD_BENCHMARKS=ON and a Release build type, then run xyworld-bench-noise
+// Exits non-zero if any sample differs
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    // Samples per setting, on a grid spaced so neighbouring samples land in different cells
+    const int GridSize(128);
+    const float Spacing(3.7f);
+
+    const std::array<int, 5> OctaveCounts = {{ 1, 3, 5, 8, 10 }};
+
+    const char* const NoiseNames[] =
+    {
+        "Value", "ValueFractal", "Perlin", "PerlinFractal", "Simplex", "SimplexFractal", "Cellular", "WhiteNoise", "Cubic", "CubicFractal"
+    };
+
+    struct Result
+    {
+        double referenceSeconds = 0.0;
+        double kernelSeconds = 0.0;
+        std::size_t samples = 0;
+        std::size_t mismatches = 0;
+    };
+
+    // Applies the same settings to either implementation
+    template<typename Noise, typename Base>
+    void configure(Noise& noise, int type, int fractal, int interp, int octaves)
+    {
+        noise.SetNoiseType(static_cast<typename Base::NoiseType>(type));
+        noise.SetFractalType(static_cast<typename Base::FractalType>(fractal));
+        noise.SetInterp(static_cast<typename Base::Interp>(interp));
+        noise.SetFractalOctaves(octaves);
+        noise.SetFrequency(0.02f);
+    }
+
+    // Fills out with the noise over the grid, returning how long it took
+    template<typename Noise>
+    double sample(const Noise& noise, std::vector<FN_DECIMAL>& out)
+    {
+        auto start = Clock::now();
+        for (int y(0); y < GridSize; y++)
+        {
+            for (int x(0); x < GridSize; x++)
+            {
+                out[y * GridSize + x] = noise.GetNoise(x * Spacing - 200.f, y * Spacing - 200.f);
+            }
+        }
+        return std::chrono::duration<double>(Clock::now() - start).count();
+    }
+
+    void compare(Result& result, int type, int fractal, int interp, int octaves)
+    {
+        FastNoiseReference::FastNoise reference(1337);
+        FastNoise kernel(1337);
+        configure<FastNoiseReference::FastNoise, FastNoiseReference::FastNoise>(reference, type, fractal, interp, octaves);
+        configure<FastNoise, FastNoiseBase>(kernel, type, fractal, interp, octaves);
+
+        std::vector<FN_DECIMAL> expected(GridSize * GridSize);
+        std::vector<FN_DECIMAL> actual(GridSize * GridSize);
+
+        // Alternated over a few passes so neither gets a warmer cache
+        for (int pass(0); pass < 3; pass++)
+        {
+            result.referenceSeconds += sample(reference, expected);
+            result.kernelSeconds += sample(kernel, actual);
+        }
+
+        for (std::size_t i(0); i < expected.size(); i++)
+        {
+            if (expected[i] != actual[i])
+                result.mismatches++;
+        }
+        result.samples += expected.size() * 3;
+    }
+}
+
+int main()
+{
+    std::array<Result, FastNoiseBase::CubicFractal + 1> results;
+
+    for (int type(FastNoiseBase::Value); type <= FastNoiseBase::CubicFractal; type++)
+    {
+        for (int fractal(FastNoiseBase::FBM); fractal <= FastNoiseBase::RigidMulti; fractal++)
+        {
+            for (int interp(FastNoiseBase::Linear); interp <= FastNoiseBase::Quintic; interp++)
+            {
+                for (auto octaves : OctaveCounts)
+                {
+                    compare(results[type], type, fractal, interp, octaves);
+                }
+            }
+        }
+    }
+
+    std::size_t mismatches = 0;
+    std::printf("%-16s %12s %12s %8s %10s\n", "Noise", "Before ns", "Kernel ns", "Speedup", "Mismatches");
+    for (std::size_t type(0); type < results.size(); type++)
+    {
+        const auto& result = results[type];
+        double before = result.referenceSeconds * 1e9 / result.samples;
+        double after = result.kernelSeconds * 1e9 / result.samples;
+        std::printf("%-16s %12.2f %12.2f %7.2fx %10zu\n", NoiseNames[type], before, after, before / after, result.mismatches);
+        mismatches += result.mismatches;
+    }
+
+    std::printf("%zu samples differ\n", mismatches);
+    return mismatches == 0 ? 0 : 1;
+}
@@ -0,0 +1,126 @@
+#include <xyginext/core/MessageBus.hpp>
+#include <xyginext/ecs/Scene.hpp>
+#include <xyginext/ecs/components/Transform.hpp>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <future>
+#include <thread>
+#include <vector>
+
+#include "Physics.hpp"
+#include "Velocity.hpp"
+
+// Times Physics at 1k, 10k and 100k bodies, then the integration on its own split across more and more workers,
+// which is where MinBodiesPerWorker in Physics.cpp comes from
+// Configure with -DBUILD_BENCHMARKS=ON and a Release build type, then run xyworld-bench-physics
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    const float Timestep(1.f / 60.f);
+    const std::array<std::size_t, 3> BodyCounts = {{ 1000, 10000, 100000 }};
+
+    // Around the same number of bodies moved at every size, for a steady mean
+    int stepsFor(std::size_t bodies)
+    {
+        return static_cast<int>(std::max<std::size_t>(50, 20000000 / bodies));
+    }
+
+    double microsecondsSince(Clock::time_point start)
+    {
+        return std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+    }
+
+    // The whole system through a scene, with the transform write back
+    void benchScene(std::size_t bodies)
+    {
+        xy::MessageBus messageBus;
+        xy::Scene scene(messageBus);
+        scene.addSystem<Physics>(messageBus);
+
+        for (std::size_t i(0); i < bodies; i++)
+        {
+            auto ent = scene.createEntity();
+            ent.addComponent<xy::Transform>().setPosition(static_cast<float>(i % 1000), static_cast<float>(i / 1000));
+            ent.addComponent<Velocity>(1.f, -1.f);
+        }
+
+        // The first update hands the new entities to the system
+        scene.update(Timestep);
+
+        auto steps = stepsFor(bodies);
+        auto start = Clock::now();
+        for (int i(0); i < steps; i++)
+        {
+            scene.update(Timestep);
+        }
+
+        auto perStep = microsecondsSince(start) / steps;
+        std::printf("%7zu bodies: %9.2fus per step, %5.2fns per body\n", bodies, perStep, perStep * 1000.0 / bodies);
+    }
+
+    // Just the integration, split the way Physics::process() does it
+    double benchSplit(std::size_t bodies, std::size_t workers)
+    {
+        std::vector<float> x(bodies, 0.f);
+        std::vector<float> y(bodies, 0.f);
+        std::vector<float> vx(bodies, 1.f);
+        std::vector<float> vy(bodies, -1.f);
+
+        auto steps = stepsFor(bodies);
+        auto start = Clock::now();
+        for (int i(0); i < steps; i++)
+        {
+            std::vector<std::future<void>> slices;
+            std::size_t sliceSize = (bodies + workers - 1) / workers;
+            for (std::size_t begin = sliceSize; begin < bodies; begin += sliceSize)
+            {
+                slices.push_back(std::async(std::launch::async, &Physics::integrate, x.data(), y.data(), vx.data(), vy.data(),
+                    begin, std::min(begin + sliceSize, bodies), Timestep));
+            }
+            Physics::integrate(x.data(), y.data(), vx.data(), vy.data(), 0, std::min(sliceSize, bodies), Timestep);
+
+            for (auto& slice : slices)
+                slice.wait();
+        }
+        return microsecondsSince(start) / steps;
+    }
+
+    // What starting and joining one worker costs, which a slice has to save to be worth it
+    double benchLaunch()
+    {
+        const int launches(2000);
+        auto start = Clock::now();
+        for (int i(0); i < launches; i++)
+        {
+            std::async(std::launch::async, [] {}).wait();
+        }
+        return microsecondsSince(start) / launches;
+    }
+}
+
+int main()
+{
+    std::printf("Physics::process through xy::Scene\n");
+    for (auto bodies : BodyCounts)
+    {
+        benchScene(bodies);
+    }
+
+    std::size_t threads = std::max(1u, std::thread::hardware_concurrency());
+    std::printf("\nIntegration alone, %zu hardware threads, %.2fus to start a worker, split from %zu bodies a worker\n",
+        threads, benchLaunch(), Physics::getMinBodiesPerWorker());
+    for (auto bodies : BodyCounts)
+    {
+        for (std::size_t workers(1); workers <= std::max<std::size_t>(threads, 4); workers *= 2)
+        {
+            auto perStep = benchSplit(bodies, workers);
+            std::printf("%7zu bodies, %2zu workers: %9.2fus per step, %5.2fns per body\n", bodies, workers, perStep, perStep * 1000.0 / bodies);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Assets packed into one file by the packer target, so startup maps a single file rather than opening each one
+// The file is a header, an index sorted by path, the paths themselves, then each entry's data at an aligned offset.
+// It's written and read in native byte order, as it's built alongside the game for the same platform.
+namespace AssetPack
+{
+    constexpr std::uint32_t Magic = 0x4b505958; // "XYPK"
+    constexpr std::uint32_t Version = 1;
+
+    // Entry data starts on a cache line, pixel data is handed straight to texture uploads
+    constexpr std::size_t Alignment = 64;
+
+    enum Kind : std::uint32_t
+    {
+        File,  // The file as it was on disk
+        Pixels // An image decoded to 32 bit RGBA, width * height * 4 bytes
+    };
+
+    struct Header
+    {
+        std::uint32_t magic;
+        std::uint32_t version;
+        std::uint32_t entryCount;
+        std::uint32_t reserved;
+    };
+
+    struct Entry
+    {
+        std::uint64_t offset;
+        std::uint64_t size;
+        std::uint32_t pathOffset; // From the end of the index
+        std::uint32_t pathLength;
+        std::uint32_t kind;
+        std::uint32_t width;  // Pixels only
+        std::uint32_t height;
+        std::uint32_t reserved;
+    };
+
+    static_assert(sizeof(Header) == 16 && sizeof(Entry) == 40, "AssetPack structs must have no padding");
+}
+
+// A read only view of a packed archive, mapped into memory for as long as this is open
+// Data handed out points straight into the mapping, nothing is copied
+class AssetArchive final
+{
+public:
+    struct Entry
+    {
+        const std::uint8_t* data = nullptr;
+        std::size_t size = 0;
+        AssetPack::Kind kind = AssetPack::File;
+        unsigned width = 0;
+        unsigned height = 0;
+    };
+
+    AssetArchive() = default;
+    ~AssetArchive();
+
+    AssetArchive(const AssetArchive&) = delete;
+    AssetArchive& operator = (const AssetArchive&) = delete;
+
+    // False if the file is missing or isn't a valid archive for this build
+    bool open(const std::string& path);
+    void close();
+    bool isOpen() const { return m_data != nullptr; }
+
+    // Looks an asset up by the path it would be loaded from as a loose file, false if it isn't packed
+    bool find(const std::string& path, Entry& entry) const;
+
+private:
+
+    const std::uint8_t* m_data = nullptr;
+    std::size_t m_size = 0;
+    const AssetPack::Entry* m_index = nullptr;
+    const char* m_paths = nullptr;
+    std::uint32_t m_entryCount = 0;
+
+#ifdef _WIN32
+    void* m_file = nullptr;
+    void* m_mapping = nullptr;
+#endif
+
+    bool validate();
+};
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <SFML/Graphics/Image.hpp>
+#include <SFML/Graphics/Texture.hpp>
+
+#include <cstddef>
+#include <future>
+#include <map>
+#include <string>
+
+#include "AssetArchive.hpp"
+
+// Reads and decodes images on worker threads, leaving only what needs the graphics context for the main one
+// Each file gets its own task, started as soon as it's queued, and update() picks up whatever has finished.
+// Anything in the asset archive is taken from there instead: pre-decoded images need no task at all,
+// they're uploaded straight out of the mapping.
+// Loaded textures are kept here rather than in an xy resource holder, which can only load from disk itself.
+class AssetLoader final
+{
+public:
+    AssetLoader() = default;
+    AssetLoader(const AssetLoader&) = delete;
+    AssetLoader& operator = (const AssetLoader&) = delete;
+
+    // Assets queued after this are looked up in the archive first, false if it couldn't be opened
+    bool openArchive(const std::string& path);
+
+    // Starts decoding straight away, queueing a path twice does nothing
+    void queueImage(const std::string& path);
+
+    // Main thread only, uploads images which have finished decoding
+    // Returns true once everything queued so far is loaded
+    bool update();
+
+    // 0 to 1, by file count
+    float getProgress() const;
+
+    // Main thread only, and only once update() has returned true
+    // Files which failed to load give an empty texture, and have already been logged
+    const sf::Texture& getTexture(const std::string& path) const;
+
+private:
+
+    struct Texture
+    {
+        AssetArchive::Entry packed;
+        std::future<sf::Image> image;
+        sf::Texture texture;
+        bool loaded = false;
+    };
+
+    // Declared first so it's unmapped after everything reading from it
+    AssetArchive m_archive;
+
+    std::map<std::string, Texture> m_textures;
+    std::size_t m_loadedCount = 0;
+};
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Packs values into the fewest bits they need, least significant bit first
+// Variable length values carry a 2 bit width class, so small numbers cost 6 bits and anything up to 32 bits at most 34
+class BitWriter final
+{
+public:
+    // Clears the buffer and writes into it, it keeps its capacity between uses
+    explicit BitWriter(std::vector<std::uint8_t>& buffer);
+
+    // The low bits of value, bits is 1 to 32
+    void write(std::uint32_t value, int bits);
+    void writeBool(bool value) { write(value ? 1 : 0, 1); }
+
+    void writeVar(std::uint32_t value);
+    void writeSigned(std::int32_t value); // Zigzag encoded so small negative values stay small
+
+    std::size_t getBitCount() const { return m_bitCount; }
+    std::size_t getByteCount() const { return (m_bitCount + 7) / 8; }
+
+    // Discards everything written after a previous bit count
+    void rewind(std::size_t bitCount);
+
+private:
+
+    std::vector<std::uint8_t>& m_buffer;
+    std::size_t m_bitCount;
+};
+
+class BitReader final
+{
+public:
+    BitReader(const std::uint8_t* data, std::size_t size);
+
+    // Reading past the end returns zeroes and marks the reader invalid
+    std::uint32_t read(int bits);
+    bool readBool() { return read(1) != 0; }
+
+    std::uint32_t readVar();
+    std::int32_t readSigned();
+
+    bool isValid() const { return m_valid; }
+
+private:
+
+    const std::uint8_t* m_data;
+    std::size_t m_bitSize;
+    std::size_t m_bitCount;
+    bool m_valid;
+};
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <SFML/System/Vector2.hpp>
+
+#include <xyginext/ecs/System.hpp>
+
+#include <random>
+
+// Wanders about near where it was spawned, for loading a server with entities to replicate
+struct Bot
+{
+    sf::Vector2f home;
+    sf::Vector2f direction; // Written to its InputState every step, so nothing else writing it takes over
+    float timer = 0.f; // Until it picks another direction
+};
+
+// Steers every bot by writing its InputState, PlayerController then moves and animates it like a player
+class BotController final : public xy::System
+{
+public:
+    BotController(xy::MessageBus&, int seed);
+
+    void process(float) override;
+
+private:
+
+    std::mt19937 m_random;
+};
@@ -0,0 +1,9 @@
+#pragma once
+
+#include <SFML/Graphics/Rect.hpp>
+
+// Box which is kept off the sea by TerrainCollision
+struct Collider
+{
+    sf::FloatRect bounds; // In world units, relative to the entity's position and unaffected by its scale
+};
@@ -1,9 +0,0 @@
-#pragma once
-
-enum Commands
-{
-    PlayerOne = 1,
-    PlayerTwo = 1 << 1,
-    PlayerThree = 1 << 2 ,
-    PlayerFour = 1 << 3,
-};
\ No newline at end of file
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <SFML/System/Vector2.hpp>
+
+#include <xyginext/ecs/System.hpp>
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+// Marks an entity as owned by whichever chunk the centre of its collider is in, as SpatialGrid files it
+// It's suspended with the chunk and rebuilt from its archetype when the chunk streams back in
+// Streamed entities need a Collider too, SpatialGrid is what finds them in an evicted chunk
+struct Streamed
+{
+    std::uint16_t archetype = 0;
+};
+
+// Suspends streamed entities in unloaded chunks into a compact blob per chunk, and restores them on reload
+// Only the archetype, position and velocity are kept, the archetype's builder adds everything else
+class EntityStreamer final : public xy::System
+{
+public:
+    // With a save path, suspended chunks are read from and written back to it so they survive a restart
+    EntityStreamer(xy::MessageBus&, int seed, const std::string& savePath);
+
+    void handleMessage(const xy::Message&) override;
+    void process(float) override;
+
+    // Called on a restored entity after its Transform, Velocity and Streamed components are added
+    using Builder = std::function<void(xy::Entity)>;
+    void registerArchetype(std::uint16_t archetype, Builder builder);
+
+    // Move restored entities along their velocity for the time they were suspended, keeping their collider's centre
+    // in their chunk. Entities which don't move come back exactly where they were suspended.
+    void setCatchUp(bool enabled) { m_catchUp = enabled; }
+
+    // Suspends every live entity and writes all chunks to the save path
+    void save();
+
+    // Entities waiting in suspended chunks, including any loaded from the save
+    std::size_t getSuspendedCount() const;
+
+private:
+
+    struct ChunkBlob
+    {
+        double suspendedAt = 0.0; // Simulation time
+        std::uint32_t count = 0;
+        std::vector<std::uint8_t> data;
+    };
+
+    int m_seed;
+    std::string m_savePath;
+    double m_time;
+    float m_residencyTimer;
+    bool m_catchUp;
+
+    std::unordered_map<std::int64_t, ChunkBlob> m_blobs;
+    std::unordered_map<std::uint16_t, Builder> m_builders;
+
+    // Chunks announced as loaded by TerrainRenderer, by chunkKey()
+    std::unordered_set<std::int64_t> m_loadedChunks;
+
+    // Suspended but not yet removed from the scene
+    std::unordered_set<xy::Entity::ID> m_suspended;
+
+    // Reused for each evicted chunk's entities
+    std::vector<xy::Entity> m_chunkEntities;
+
+    void onEntityRemoved(xy::Entity) override;
+
+    void suspend(xy::Entity, sf::Vector2i chunk);
+    void restore(sf::Vector2i chunk);
+
+    void load();
+};
@@ -31,27 +31,42 @@
 #ifndef FASTNOISE_H
 #define FASTNOISE_H
 
-// Uncomment the line below to use doubles throughout FastNoise instead of floats
+#include <vector>
+
+// FastNoiseT<float> and FastNoiseT<double> are both always available
+// Uncomment the line below to make the FastNoise alias use doubles instead of floats
 //#define FN_USE_DOUBLES
 
 #define FN_CELLULAR_INDEX_MAX 3
 
+// Maximum number of layers evaluated together by FillSimplexFractalLayers(), and octaves for any fractal noise
+#define FN_MAX_FUSED_LAYERS 8
+#define FN_MAX_FUSED_OCTAVES 16
+
+// Fractal octave counts up to this are unrolled at compile time, higher counts use a runtime loop
+#define FN_KERNEL_MAX_OCTAVES 8
+
 #ifdef FN_USE_DOUBLES
 typedef double FN_DECIMAL;
 #else
 typedef float FN_DECIMAL;
 #endif
 
-class FastNoise
+// Settings shared by both precisions
+struct FastNoiseBase
 {
-public:
-	explicit FastNoise(int seed = 1337) { SetSeed(seed); CalculateFractalBounding(); }
-
 	enum NoiseType { Value, ValueFractal, Perlin, PerlinFractal, Simplex, SimplexFractal, Cellular, WhiteNoise, Cubic, CubicFractal };
 	enum Interp { Linear, Hermite, Quintic };
 	enum FractalType { FBM, Billow, RigidMulti };
 	enum CellularDistanceFunction { Euclidean, Manhattan, Natural };
 	enum CellularReturnType { CellValue, NoiseLookup, Distance, Distance2, Distance2Add, Distance2Sub, Distance2Mul, Distance2Div };
+};
+
+template<typename T>
+class FastNoiseT : public FastNoiseBase
+{
+public:
+	explicit FastNoiseT(int seed = 1337) { SetSeed(seed); CalculateFractalBounding(); ResolveKernels(); }
 
 	// Sets seed used for all noise types
 	// Default: 1337
@@ -62,10 +77,10 @@ public:
 
 	// Sets frequency for all noise types
 	// Default: 0.01
-	void SetFrequency(FN_DECIMAL frequency) { m_frequency = frequency; }
+	void SetFrequency(T frequency) { m_frequency = frequency; }
 
 	// Returns frequency used for all noise types
-	FN_DECIMAL GetFrequency() const { return m_frequency; }
+	T GetFrequency() const { return m_frequency; }
 
 	// Changes the interpolation method used to smooth between noise values
 	// Possible interpolation methods (lowest to highest quality) :
@@ -74,7 +89,7 @@ public:
 	// - Quintic
 	// Used in Value, Perlin Noise and Position Warping
 	// Default: Quintic
-	void SetInterp(Interp interp) { m_interp = interp; }
+	void SetInterp(Interp interp) { m_interp = interp; ResolveKernels(); }
 
 	// Returns interpolation method used for supported noise types
 	Interp GetInterp() const { return m_interp; }
@@ -87,29 +102,35 @@ public:
 	NoiseType GetNoiseType() const { return m_noiseType; }
 
 	// Sets octave count for all fractal noise types
+	// Clamped to 1 - FN_MAX_FUSED_OCTAVES, the fused evaluator keeps per-octave state on the stack
 	// Default: 3
-	void SetFractalOctaves(int octaves) { m_octaves = octaves; CalculateFractalBounding(); }
+	void SetFractalOctaves(int octaves)
+	{
+		m_octaves = octaves < 1 ? 1 : octaves > FN_MAX_FUSED_OCTAVES ? FN_MAX_FUSED_OCTAVES : octaves;
+		CalculateFractalBounding();
+		ResolveKernels();
+	}
 
 	// Returns octave count for all fractal noise types
 	int GetFractalOctaves() const { return m_octaves; }
 	
 	// Sets octave lacunarity for all fractal noise types
 	// Default: 2.0
-	void SetFractalLacunarity(FN_DECIMAL lacunarity) { m_lacunarity = lacunarity; }
+	void SetFractalLacunarity(T lacunarity) { m_lacunarity = lacunarity; }
 
 	// Returns octave lacunarity for all fractal noise types
-	FN_DECIMAL GetFractalLacunarity() const { return m_lacunarity; }
+	T GetFractalLacunarity() const { return m_lacunarity; }
 
 	// Sets octave gain for all fractal noise types
 	// Default: 0.5
-	void SetFractalGain(FN_DECIMAL gain) { m_gain = gain; CalculateFractalBounding(); }
+	void SetFractalGain(T gain) { m_gain = gain; CalculateFractalBounding(); }
 
 	// Returns octave gain for all fractal noise types
-	FN_DECIMAL GetFractalGain() const { return m_gain; }
+	T GetFractalGain() const { return m_gain; }
 
 	// Sets method for combining octaves in all fractal noise types
 	// Default: FBM
-	void SetFractalType(FractalType fractalType) { m_fractalType = fractalType; }
+	void SetFractalType(FractalType fractalType) { m_fractalType = fractalType; ResolveKernels(); }
 
 	// Returns method for combining octaves in all fractal noise types
 	FractalType GetFractalType() const { return m_fractalType; }
@@ -125,17 +146,17 @@ public:
 	// Sets return type from cellular noise calculations
 	// Note: NoiseLookup requires another FastNoise object be set with SetCellularNoiseLookup() to function
 	// Default: CellValue
-	void SetCellularReturnType(CellularReturnType cellularReturnType) { m_cellularReturnType = cellularReturnType; }
+	void SetCellularReturnType(CellularReturnType cellularReturnType) { m_cellularReturnType = cellularReturnType; ResolveKernels(); }
 
 	// Returns the return type from cellular noise calculations
 	CellularReturnType GetCellularReturnType() const { return m_cellularReturnType; }
 
 	// Noise used to calculate a cell value if cellular return type is NoiseLookup
 	// The lookup value is acquired through GetNoise() so ensure you SetNoiseType() on the noise lookup, value, Perlin or simplex is recommended
-	void SetCellularNoiseLookup(FastNoise* noise) { m_cellularNoiseLookup = noise; }
+	void SetCellularNoiseLookup(FastNoiseT* noise) { m_cellularNoiseLookup = noise; }
 
 	// Returns the noise used to calculate a cell value if the cellular return type is NoiseLookup
-	FastNoise* GetCellularNoiseLookup() const { return m_cellularNoiseLookup; }
+	FastNoiseT* GetCellularNoiseLookup() const { return m_cellularNoiseLookup; }
 
 	// Sets the 2 distance indices used for distance2 return types
 	// Default: 0, 1
@@ -149,151 +170,186 @@ public:
 	// Sets the maximum distance a cellular point can move from its grid position
 	// Setting this high will make artifacts more common
 	// Default: 0.45
-	void SetCellularJitter(FN_DECIMAL cellularJitter) { m_cellularJitter = cellularJitter; }
+	void SetCellularJitter(T cellularJitter) { m_cellularJitter = cellularJitter; }
 
 	// Returns the maximum distance a cellular point can move from its grid position
-	FN_DECIMAL GetCellularJitter() const { return m_cellularJitter; }
+	T GetCellularJitter() const { return m_cellularJitter; }
 
 	// Sets the maximum warp distance from original location when using GradientPerturb{Fractal}(...)
 	// Default: 1.0
-	void SetGradientPerturbAmp(FN_DECIMAL gradientPerturbAmp) { m_gradientPerturbAmp = gradientPerturbAmp; }
+	void SetGradientPerturbAmp(T gradientPerturbAmp) { m_gradientPerturbAmp = gradientPerturbAmp; }
 
 	// Returns the maximum warp distance from original location when using GradientPerturb{Fractal}(...)
-	FN_DECIMAL GetGradientPerturbAmp() const { return m_gradientPerturbAmp; }
+	T GetGradientPerturbAmp() const { return m_gradientPerturbAmp; }
 
 	//2D
-	FN_DECIMAL GetValue(FN_DECIMAL x, FN_DECIMAL y) const;
-	FN_DECIMAL GetValueFractal(FN_DECIMAL x, FN_DECIMAL y) const;
+	T GetValue(T x, T y) const;
+	T GetValueFractal(T x, T y) const;
+
+	T GetPerlin(T x, T y) const;
+	T GetPerlinFractal(T x, T y) const;
+
+	T GetSimplex(T x, T y) const;
+	T GetSimplexFractal(T x, T y) const;
 
-	FN_DECIMAL GetPerlin(FN_DECIMAL x, FN_DECIMAL y) const;
-	FN_DECIMAL GetPerlinFractal(FN_DECIMAL x, FN_DECIMAL y) const;
+	T GetCellular(T x, T y) const;
 
-	FN_DECIMAL GetSimplex(FN_DECIMAL x, FN_DECIMAL y) const;
-	FN_DECIMAL GetSimplexFractal(FN_DECIMAL x, FN_DECIMAL y) const;
+	// Fills a grid of cellular noise sampled at (xStart + x * step, yStart + y * step), out receives xSize * ySize values in row-major order
+	// Each cell's feature point (and cell value or noise lookup) is computed once for the whole grid rather than per sample
+	// Results are identical to calling GetCellular() at each position
+	void GetCellularGrid(T* out, T xStart, T yStart, int xSize, int ySize, T step = 1) const;
 
-	FN_DECIMAL GetCellular(FN_DECIMAL x, FN_DECIMAL y) const;
+	// As above but sampled at (xOrigin + xStart + x * step, yOrigin + yStart + y * step)
+	// The origin is resolved to a cell in double precision and only the local offset is evaluated in T
+	void GetCellularGrid(T* out, int xOrigin, int yOrigin, T xStart, T yStart, int xSize, int ySize, T step = 1) const;
 
-	FN_DECIMAL GetWhiteNoise(FN_DECIMAL x, FN_DECIMAL y) const;
-	FN_DECIMAL GetWhiteNoiseInt(int x, int y) const;
+	// Working storage for GetCellularGrid(), which otherwise allocates its own on every call
+	// Keep one per thread and pass it in, once it's grown to fit the grid size nothing more is allocated
+	struct CellularGridScratch
+	{
+		struct CellPoint
+		{
+			T x, y, value;
+		};
 
-	FN_DECIMAL GetCubic(FN_DECIMAL x, FN_DECIMAL y) const;
-	FN_DECIMAL GetCubicFractal(FN_DECIMAL x, FN_DECIMAL y) const;
+		std::vector<T> xs;
+		std::vector<T> ys;
+		std::vector<int> xrs;
+		std::vector<int> yrs;
+		std::vector<CellPoint> cells;
+	};
 
-	FN_DECIMAL GetNoise(FN_DECIMAL x, FN_DECIMAL y) const;
+	void GetCellularGrid(T* out, int xOrigin, int yOrigin, T xStart, T yStart, int xSize, int ySize, CellularGridScratch& scratch, T step = 1) const;
 
-	void GradientPerturb(FN_DECIMAL& x, FN_DECIMAL& y) const;
-	void GradientPerturbFractal(FN_DECIMAL& x, FN_DECIMAL& y) const;
+	T GetWhiteNoise(T x, T y) const;
+	T GetWhiteNoiseInt(int x, int y) const;
+
+	T GetCubic(T x, T y) const;
+	T GetCubicFractal(T x, T y) const;
+
+	T GetNoise(T x, T y) const;
+
+	void GradientPerturb(T& x, T& y) const;
+	void GradientPerturbFractal(T& x, T& y) const;
+
+	// Returns true if both objects sample the same simplex lattice at every octave
+	// (same frequency, lacunarity and octave count) so they can be fused
+	static bool CanFuseLayers(const FastNoiseT& a, const FastNoiseT& b);
+
+	// Fills up to FN_MAX_FUSED_LAYERS SimplexFractal layers over a grid of integer sample positions in one pass
+	// The skew, floor and falloff work for each octave is shared, only the gradient hashing is per layer
+	// All layers must satisfy CanFuseLayers() with layers[0], SetFractalOctaves() keeps them within FN_MAX_FUSED_OCTAVES
+	// out[i] receives xSize * ySize values in row-major order
+	// Samples are taken at (xOrigin + xStart + x, yOrigin + yStart + y), the origin is resolved in double precision
+	// and only the local offset is evaluated in T, so precision doesn't degrade far from (0, 0)
+	// Results match GetSimplexFractal() to within rounding of T, calls sharing an origin are consistent with each other
+	static void FillSimplexFractalLayers(const FastNoiseT* const* layers, int layerCount, int xOrigin, int yOrigin, int xStart, int yStart, int xSize, int ySize, T* const* out);
 
 	//3D
-	FN_DECIMAL GetValue(FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL z) const;
-	FN_DECIMAL GetValueFractal(FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL z) const;
+	T GetValue(T x, T y, T z) const;
+	T GetValueFractal(T x, T y, T z) const;
 
-	FN_DECIMAL GetPerlin(FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL z) const;
-	FN_DECIMAL GetPerlinFractal(FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL z) const;
+	T GetPerlin(T x, T y, T z) const;
+	T GetPerlinFractal(T x, T y, T z) const;
 
-	FN_DECIMAL GetSimplex(FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL z) const;
-	FN_DECIMAL GetSimplexFractal(FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL z) const;
+	T GetSimplex(T x, T y, T z) const;
+	T GetSimplexFractal(T x, T y, T z) const;
 
-	FN_DECIMAL GetCellular(FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL z) const;
+	T GetCellular(T x, T y, T z) const;
 
-	FN_DECIMAL GetWhiteNoise(FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL z) const;
-	FN_DECIMAL GetWhiteNoiseInt(int x, int y, int z) const;
+	T GetWhiteNoise(T x, T y, T z) const;
+	T GetWhiteNoiseInt(int x, int y, int z) const;
 
-	FN_DECIMAL GetCubic(FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL z) const;
-	FN_DECIMAL GetCubicFractal(FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL z) const;
+	T GetCubic(T x, T y, T z) const;
+	T GetCubicFractal(T x, T y, T z) const;
 
-	FN_DECIMAL GetNoise(FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL z) const;
+	T GetNoise(T x, T y, T z) const;
 
-	void GradientPerturb(FN_DECIMAL& x, FN_DECIMAL& y, FN_DECIMAL& z) const;
-	void GradientPerturbFractal(FN_DECIMAL& x, FN_DECIMAL& y, FN_DECIMAL& z) const;
+	void GradientPerturb(T& x, T& y, T& z) const;
+	void GradientPerturbFractal(T& x, T& y, T& z) const;
 
 	//4D
-	FN_DECIMAL GetSimplex(FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL z, FN_DECIMAL w) const;
+	T GetSimplex(T x, T y, T z, T w) const;
 
-	FN_DECIMAL GetWhiteNoise(FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL z, FN_DECIMAL w) const;
-	FN_DECIMAL GetWhiteNoiseInt(int x, int y, int z, int w) const;
+	T GetWhiteNoise(T x, T y, T z, T w) const;
+	T GetWhiteNoiseInt(int x, int y, int z, int w) const;
 
 private:
 	unsigned char m_perm[512];
 	unsigned char m_perm12[512];
 
 	int m_seed = 1337;
-	FN_DECIMAL m_frequency = FN_DECIMAL(0.01);
+	T m_frequency = T(0.01);
 	Interp m_interp = Quintic;
 	NoiseType m_noiseType = Simplex;
 
 	int m_octaves = 3;
-	FN_DECIMAL m_lacunarity = FN_DECIMAL(2);
-	FN_DECIMAL m_gain = FN_DECIMAL(0.5);
+	T m_lacunarity = T(2);
+	T m_gain = T(0.5);
 	FractalType m_fractalType = FBM;
-	FN_DECIMAL m_fractalBounding;
+	T m_fractalBounding;
 
 	CellularDistanceFunction m_cellularDistanceFunction = Euclidean;
 	CellularReturnType m_cellularReturnType = CellValue;
-	FastNoise* m_cellularNoiseLookup = nullptr;
+	FastNoiseT* m_cellularNoiseLookup = nullptr;
 	int m_cellularDistanceIndex0 = 0;
 	int m_cellularDistanceIndex1 = 1;
-	FN_DECIMAL m_cellularJitter = FN_DECIMAL(0.45);
+	T m_cellularJitter = T(0.45);
 
-	FN_DECIMAL m_gradientPerturbAmp = FN_DECIMAL(1);
+	T m_gradientPerturbAmp = T(1);
 
 	void CalculateFractalBounding();
 
-	//2D
-	FN_DECIMAL SingleValueFractalFBM(FN_DECIMAL x, FN_DECIMAL y) const;
-	FN_DECIMAL SingleValueFractalBillow(FN_DECIMAL x, FN_DECIMAL y) const;
-	FN_DECIMAL SingleValueFractalRigidMulti(FN_DECIMAL x, FN_DECIMAL y) const;
-	FN_DECIMAL SingleValue(unsigned char offset, FN_DECIMAL x, FN_DECIMAL y) const;
+	// Noise functions resolved for the current settings, indexed by NoiseType
+	// 2D getters call through these so the type, fractal, interp and octave selection happens once in ResolveKernels()
+	typedef T(*Kernel2D)(const FastNoiseT& noise, T x, T y);
+	Kernel2D m_kernel2D[CubicFractal + 1];
 
-	FN_DECIMAL SinglePerlinFractalFBM(FN_DECIMAL x, FN_DECIMAL y) const;
-	FN_DECIMAL SinglePerlinFractalBillow(FN_DECIMAL x, FN_DECIMAL y) const;
-	FN_DECIMAL SinglePerlinFractalRigidMulti(FN_DECIMAL x, FN_DECIMAL y) const;
-	FN_DECIMAL SinglePerlin(unsigned char offset, FN_DECIMAL x, FN_DECIMAL y) const;
+	void ResolveKernels();
 
-	FN_DECIMAL SingleSimplexFractalFBM(FN_DECIMAL x, FN_DECIMAL y) const;
-	FN_DECIMAL SingleSimplexFractalBillow(FN_DECIMAL x, FN_DECIMAL y) const;
-	FN_DECIMAL SingleSimplexFractalRigidMulti(FN_DECIMAL x, FN_DECIMAL y) const;
-	FN_DECIMAL SingleSimplexFractalBlend(FN_DECIMAL x, FN_DECIMAL y) const;
-	FN_DECIMAL SingleSimplex(unsigned char offset, FN_DECIMAL x, FN_DECIMAL y) const;
+	template<typename, NoiseType, FractalType, Interp, int> friend struct NoiseKernel;
 
-	FN_DECIMAL SingleCubicFractalFBM(FN_DECIMAL x, FN_DECIMAL y) const;
-	FN_DECIMAL SingleCubicFractalBillow(FN_DECIMAL x, FN_DECIMAL y) const;
-	FN_DECIMAL SingleCubicFractalRigidMulti(FN_DECIMAL x, FN_DECIMAL y) const;
-	FN_DECIMAL SingleCubic(unsigned char offset, FN_DECIMAL x, FN_DECIMAL y) const;
+	//2D
+	T SingleSimplexFractalBlend(T x, T y) const;
+	T SingleSimplex(unsigned char offset, T x, T y) const;
+
+	T SingleCubic(unsigned char offset, T x, T y) const;
 
-	FN_DECIMAL SingleCellular(FN_DECIMAL x, FN_DECIMAL y) const;
-	FN_DECIMAL SingleCellular2Edge(FN_DECIMAL x, FN_DECIMAL y) const;
+	T SingleCellular(T x, T y) const;
+	T SingleCellular2Edge(T x, T y) const;
+	void SingleCellularGrid(T* out, int xCell, int yCell, T xOffset, T yOffset, T xStart, T yStart, int xSize, int ySize, T step, CellularGridScratch& scratch) const;
+	template<CellularDistanceFunction> void SingleCellularGrid(T* out, int xCell, int yCell, T xOffset, T yOffset, T xStart, T yStart, int xSize, int ySize, T step, CellularGridScratch& scratch) const;
 
-	void SingleGradientPerturb(unsigned char offset, FN_DECIMAL warpAmp, FN_DECIMAL frequency, FN_DECIMAL& x, FN_DECIMAL& y) const;
+	void SingleGradientPerturb(unsigned char offset, T warpAmp, T frequency, T& x, T& y) const;
 
 	//3D
-	FN_DECIMAL SingleValueFractalFBM(FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL z) const;
-	FN_DECIMAL SingleValueFractalBillow(FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL z) const;
-	FN_DECIMAL SingleValueFractalRigidMulti(FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL z) const;
-	FN_DECIMAL SingleValue(unsigned char offset, FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL z) const;
+	T SingleValueFractalFBM(T x, T y, T z) const;
+	T SingleValueFractalBillow(T x, T y, T z) const;
+	T SingleValueFractalRigidMulti(T x, T y, T z) const;
+	T SingleValue(unsigned char offset, T x, T y, T z) const;
 
-	FN_DECIMAL SinglePerlinFractalFBM(FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL z) const;
-	FN_DECIMAL SinglePerlinFractalBillow(FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL z) const;
-	FN_DECIMAL SinglePerlinFractalRigidMulti(FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL z) const;
-	FN_DECIMAL SinglePerlin(unsigned char offset, FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL z) const;
+	T SinglePerlinFractalFBM(T x, T y, T z) const;
+	T SinglePerlinFractalBillow(T x, T y, T z) const;
+	T SinglePerlinFractalRigidMulti(T x, T y, T z) const;
+	T SinglePerlin(unsigned char offset, T x, T y, T z) const;
 
-	FN_DECIMAL SingleSimplexFractalFBM(FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL z) const;
-	FN_DECIMAL SingleSimplexFractalBillow(FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL z) const;
-	FN_DECIMAL SingleSimplexFractalRigidMulti(FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL z) const;
-	FN_DECIMAL SingleSimplex(unsigned char offset, FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL z) const;
+	T SingleSimplexFractalFBM(T x, T y, T z) const;
+	T SingleSimplexFractalBillow(T x, T y, T z) const;
+	T SingleSimplexFractalRigidMulti(T x, T y, T z) const;
+	T SingleSimplex(unsigned char offset, T x, T y, T z) const;
 
-	FN_DECIMAL SingleCubicFractalFBM(FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL z) const;
-	FN_DECIMAL SingleCubicFractalBillow(FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL z) const;
-	FN_DECIMAL SingleCubicFractalRigidMulti(FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL z) const;
-	FN_DECIMAL SingleCubic(unsigned char offset, FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL z) const;
+	T SingleCubicFractalFBM(T x, T y, T z) const;
+	T SingleCubicFractalBillow(T x, T y, T z) const;
+	T SingleCubicFractalRigidMulti(T x, T y, T z) const;
+	T SingleCubic(unsigned char offset, T x, T y, T z) const;
 
-	FN_DECIMAL SingleCellular(FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL z) const;
-	FN_DECIMAL SingleCellular2Edge(FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL z) const;
+	T SingleCellular(T x, T y, T z) const;
+	T SingleCellular2Edge(T x, T y, T z) const;
 
-	void SingleGradientPerturb(unsigned char offset, FN_DECIMAL warpAmp, FN_DECIMAL frequency, FN_DECIMAL& x, FN_DECIMAL& y, FN_DECIMAL& z) const;
+	void SingleGradientPerturb(unsigned char offset, T warpAmp, T frequency, T& x, T& y, T& z) const;
 
 	//4D
-	FN_DECIMAL SingleSimplex(unsigned char offset, FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL z, FN_DECIMAL w) const;
+	T SingleSimplex(unsigned char offset, T x, T y, T z, T w) const;
 
 	inline unsigned char Index2D_12(unsigned char offset, int x, int y) const;
 	inline unsigned char Index3D_12(unsigned char offset, int x, int y, int z) const;
@@ -302,10 +358,17 @@ private:
 	inline unsigned char Index3D_256(unsigned char offset, int x, int y, int z) const;
 	inline unsigned char Index4D_256(unsigned char offset, int x, int y, int z, int w) const;
 
-	inline FN_DECIMAL ValCoord2DFast(unsigned char offset, int x, int y) const;
-	inline FN_DECIMAL ValCoord3DFast(unsigned char offset, int x, int y, int z) const;
-	inline FN_DECIMAL GradCoord2D(unsigned char offset, int x, int y, FN_DECIMAL xd, FN_DECIMAL yd) const;
-	inline FN_DECIMAL GradCoord3D(unsigned char offset, int x, int y, int z, FN_DECIMAL xd, FN_DECIMAL yd, FN_DECIMAL zd) const;
-	inline FN_DECIMAL GradCoord4D(unsigned char offset, int x, int y, int z, int w, FN_DECIMAL xd, FN_DECIMAL yd, FN_DECIMAL zd, FN_DECIMAL wd) const;
+	inline T ValCoord2DFast(unsigned char offset, int x, int y) const;
+	inline T ValCoord3DFast(unsigned char offset, int x, int y, int z) const;
+	inline T GradCoord2D(unsigned char offset, int x, int y, T xd, T yd) const;
+	inline T GradCoord3D(unsigned char offset, int x, int y, int z, T xd, T yd, T zd) const;
+	inline T GradCoord4D(unsigned char offset, int x, int y, int z, int w, T xd, T yd, T zd, T wd) const;
 };
+
+// Both precisions are always compiled, FN_USE_DOUBLES only selects which one FastNoise refers to
+extern template class FastNoiseT<float>;
+extern template class FastNoiseT<double>;
+
+typedef FastNoiseT<FN_DECIMAL> FastNoise;
+
 #endif
@@ -0,0 +1,16 @@
+#pragma once
+
+#include <vector>
+
+// Collects real frame (or server tick) times for a before/after summary of a run
+class FrameStats final
+{
+public:
+    void addFrame(float seconds) { m_frames.push_back(seconds); }
+
+    // Logs the count, mean, p50/p95/p99 and the longest hitch, in milliseconds
+    void logSummary(const char* name = "frames") const;
+
+private:
+    std::vector<float> m_frames;
+};
@@ -30,6 +30,9 @@ source distribution.
 
 #include <xyginext/core/App.hpp>
 
+#include "FrameStats.hpp"
+#include "LoadingState.hpp"
+
 class Game final : public xy::App
 {
 public:
@@ -40,7 +43,10 @@ public:
 
 private:
 
+    // Declared first so it outlives the states which use it
+    Preload m_preload;
     xy::StateStack m_stateStack;
+    FrameStats m_frameStats;
 
     void handleEvent(const sf::Event&) override;
     void handleMessage(const xy::Message&) override;
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// 64 bit FNV-1a, for content hashes which have to match across machines
+constexpr std::uint64_t FnvOffset(14695981039346656037ull);
+constexpr std::uint64_t FnvPrime(1099511628211ull);
+
+inline std::uint64_t fnv1a(const void* data, std::size_t size, std::uint64_t hash = FnvOffset)
+{
+    auto bytes = static_cast<const std::uint8_t*>(data);
+    for (std::size_t i(0); i < size; i++)
+    {
+        hash ^= bytes[i];
+        hash *= FnvPrime;
+    }
+    return hash;
+}
+
+// Hashes a single value's bytes, only for types without padding
+template <typename T>
+std::uint64_t fnv1aValue(const T& value, std::uint64_t hash = FnvOffset)
+{
+    return fnv1a(&value, sizeof(T), hash);
+}
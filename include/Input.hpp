@@ -1,13 +1,40 @@
 #pragma once
 
 #include <SFML/System/Vector2.hpp>
+#include <SFML/Window/Joystick.hpp>
 #include <SFML/Window/Keyboard.hpp>
 
 #include <xyginext/ecs/Director.hpp>
 
 #include <array>
+#include <bitset>
+#include <chrono>
+#include <cstdint>
+#include <string>
 
-#include <set>
+#include "InputRecording.hpp"
+#include "InputState.hpp"
+#include "SpscRing.hpp"
+
+// A raw input event, stamped when it was taken from the window
+struct InputEvent
+{
+    using Clock = std::chrono::steady_clock;
+
+    enum Type : std::uint8_t
+    {
+        KeyPressed,
+        KeyReleased,
+        JoystickMoved
+    };
+
+    Clock::time_point time;
+    Type type = KeyPressed;
+    sf::Keyboard::Key key = sf::Keyboard::Unknown;
+    unsigned int joystick = 0;
+    sf::Joystick::Axis axis = sf::Joystick::X;
+    float position = 0.f;
+};
 
 struct InputData
 {
@@ -17,12 +44,41 @@ struct InputData
 class InputDirector : public xy::Director
 {
 public:
+    InputDirector();
+
     void handleMessage(const xy::Message& msg) override {};
     void handleEvent(const sf::Event&) override;
     void process(float) override;
 
+    // Time of the oldest event applied since the last call, for latency reporting
+    // Returns false if nothing has been applied
+    bool takeOldestApplied(InputEvent::Clock::time_point& time);
+
+    // Writes every step's player movement and key state to path, along with the world seed and timestep
+    bool startRecording(const std::string& path, int seed, float timestep);
+
+    // Replaces live input with a recording until it runs out
+    // The recording's seed and timestep are available once this succeeds
+    bool startPlayback(const std::string& path);
+    int getPlaybackSeed() const { return m_playback.getSeed(); }
+    float getPlaybackTimestep() const { return m_playback.getTimestep(); }
+    bool isPlaybackFinished() const { return m_playbackFinished; }
+
 private:
-    std::array<InputData,4> m_playerInput;
+    // Queued by handleEvent(), consumed in order by process()
+    SpscRing<InputEvent, 256> m_events;
+
+    std::array<InputData, PlayerCount> m_playerInput;
+    std::bitset<sf::Keyboard::KeyCount> m_keys;
 
-    std::set<sf::Keyboard::Key> m_pressedKeys;
-};
\ No newline at end of file
+    InputEvent::Clock::time_point m_lastProcess;
+    InputEvent::Clock::time_point m_oldestApplied;
+    bool m_hasApplied;
+
+    InputRecorder m_recorder;
+    InputPlayer m_playback;
+    bool m_playbackFinished;
+
+    void apply(const InputEvent&);
+    sf::Vector2f getMovement(Player) const;
+};
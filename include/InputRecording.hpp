@@ -0,0 +1,55 @@
+#pragma once
+
+#include <array>
+#include <bitset>
+#include <cstdint>
+#include <fstream>
+#include <string>
+
+#include <SFML/System/Vector2.hpp>
+#include <SFML/Window/Keyboard.hpp>
+
+#include "InputState.hpp"
+
+// Input for one simulation step as written to a recording
+struct RecordedFrame
+{
+    std::array<sf::Vector2f, PlayerCount> movement;
+    std::bitset<sf::Keyboard::KeyCount> keys;
+};
+
+// File layout: a header (magic, version, world seed, timestep) then one entry per step
+// Each entry is a flags byte saying which players' movement and whether the key state changed since
+// the previous step, followed by only the changed values, so idle steps cost a single byte
+class InputRecorder final
+{
+public:
+    bool open(const std::string& path, int seed, float timestep);
+    void write(const RecordedFrame&);
+
+private:
+    std::ofstream m_file;
+    RecordedFrame m_last;
+};
+
+class InputPlayer final
+{
+public:
+    bool open(const std::string& path);
+    bool isOpen() const { return m_file.is_open(); }
+
+    // World seed the recording was made with
+    int getSeed() const { return m_seed; }
+
+    // Simulation timestep the recording was made with, it only replays exactly at the same one
+    float getTimestep() const { return m_timestep; }
+
+    // Returns false once the recording is exhausted
+    bool read(RecordedFrame&);
+
+private:
+    std::ifstream m_file;
+    RecordedFrame m_last;
+    int m_seed = 0;
+    float m_timestep = 0.f;
+};
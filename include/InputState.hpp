@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstdint>
+
+#include <SFML/System/Vector2.hpp>
+
+// Local player slots, one per controller
+enum Player : std::int8_t
+{
+    NoPlayer = -1,
+    PlayerOne,
+    PlayerTwo,
+    PlayerThree,
+    PlayerFour,
+    PlayerCount
+};
+
+// World units per second at full deflection (previously one unit per frame at 60fps)
+constexpr float PlayerSpeed(60.f);
+
+// What an entity has been told to do this step
+// Written by InputDirector for the player slots, anything else (AI) can write it directly
+struct InputState
+{
+    sf::Vector2f movement; // -1 to 1 on each axis, averaged over the step
+    Player player = NoPlayer;
+
+    int animation = -1; // Owned by PlayerController, the walk animation currently playing
+};
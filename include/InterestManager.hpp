@@ -0,0 +1,48 @@
+#pragma once
+
+#include <SFML/System/Vector2.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "Snapshot.hpp"
+
+// Decides which replicated entities each client is sent
+// A client is subscribed to the chunks it would have loaded around its focus, the same draw distance
+// TerrainRenderer streams by, and only sees entities standing in them. Subscriptions only change
+// when a client crosses into another chunk, and entities are handed out by walking each chunk's
+// subscribers, so the cost follows what's sent rather than entities times clients.
+class InterestManager final
+{
+public:
+    // Moves a client's focus, resubscribing only if it's crossed into another chunk
+    void setFocus(std::uint32_t client, sf::Vector2f position);
+    void removeClient(std::uint32_t client);
+
+    // Files each entity in the snapshot with every client subscribed to its chunk
+    void update(const Snapshot&);
+
+    // Indices into the snapshot passed to update(), sorted, for a client with a focus
+    const std::vector<std::size_t>& getRelevant(std::uint32_t client) const;
+
+    // Where the client last said it was, for prioritising by distance
+    sf::Vector2f getFocus(std::uint32_t client) const;
+
+private:
+
+    struct Subscriber
+    {
+        sf::Vector2f focus;
+        sf::Vector2i focusChunk;
+        std::vector<std::int64_t> chunks;
+        std::vector<std::size_t> relevant;
+    };
+
+    std::unordered_map<std::uint32_t, Subscriber> m_subscribers;
+    std::unordered_map<std::int64_t, std::vector<std::uint32_t>> m_chunkSubscribers;
+
+    void subscribe(std::uint32_t client, std::int64_t chunk);
+    void unsubscribe(std::uint32_t client, std::int64_t chunk);
+};
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <string>
+
+// Command line options, parsed once in main()
+//  --seed <n>          world seed
+//  --tick-rate <hz>    simulation steps per second
+//  --record <file>     record player input to file
+//  --playback <file>   play back a recording (overrides --seed and --tick-rate with the recorded ones)
+//  --port <n>          port the server listens on or the game connects to, 0 for the default
+//  --connect <address> join a server, its terrain replaces --seed
+//  --sim-loss <pct>    drop this percentage of outgoing datagrams
+//  --sim-latency <ms>  hold outgoing datagrams back this long
+//  --sim-jitter <ms>   plus up to this much more, at random
+// Game only
+//  --pipelined         step the world on its own thread, drawing snapshots of it on the main one
+// Server only
+//  --ticks <n>         stop after n ticks, 0 runs until a playback ends or the process is interrupted
+//  --unthrottled       tick as fast as possible rather than in real time
+//  --bots <n>          spawn n wandering entities for clients to be sent
+//  --clients <n>       rather than serving, join the server at --connect as n headless clients which wander like bots
+struct LaunchOptions
+{
+    int seed = 1337;
+    float tickRate = 60.f;
+    std::string recordPath;
+    std::string playbackPath;
+
+    unsigned short port = 0;
+    std::string connectAddress;
+
+    float simLoss = 0.f;    // 0 to 1
+    float simLatency = 0.f; // Seconds
+    float simJitter = 0.f;  // Seconds
+
+    bool pipelined = false;
+
+    int tickLimit = 0;
+    bool unthrottled = false;
+    int bots = 0;
+    int clients = 0;
+};
+
+void parseLaunchOptions(int argc, char** argv);
+const LaunchOptions& getLaunchOptions();
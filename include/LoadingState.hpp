@@ -0,0 +1,62 @@
+#pragma once
+
+#include <xyginext/core/State.hpp>
+
+#include <chrono>
+#include <future>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "AssetLoader.hpp"
+#include "States.hpp"
+#include "TerrainChunk.hpp"
+#include "TerrainGenerator.hpp"
+#include "WorldClient.hpp"
+
+namespace AssetPaths
+{
+    // Built by the packer target, the loose files are loaded instead if it's missing
+    const std::string Archive("assets.pak");
+
+    const std::string TerrainSheet("assets/Roguelike_pack/Spritesheet/roguelikeSheet_transparent.png");
+}
+
+// What LoadingState prepares for WorldState, owned by Game so it outlives both
+struct Preload final
+{
+    AssetLoader assets;
+
+    // Only when joined to a server, the world is built from the terrain it sends
+    std::unique_ptr<WorldClient> client;
+
+    // The 3x3 chunks around where the player starts, generated from params
+    TerrainGenerator::Params params{};
+    std::vector<TerrainChunk> chunks;
+
+    // For the time until the first frame the player can act in
+    std::chrono::steady_clock::time_point launchTime = std::chrono::steady_clock::now();
+};
+
+// Shown while assets decode and the first chunks generate on worker threads, then replaced by WorldState
+// Joining a server happens here too, as the starting chunks are generated from its terrain parameters
+class LoadingState final : public xy::State
+{
+public:
+    LoadingState(xy::StateStack&, xy::State::Context, Preload&);
+
+    xy::StateID stateID() const override { return States::WorldLoadState; }
+
+    bool handleEvent(const sf::Event&) override;
+    void handleMessage(const xy::Message&) override;
+    bool update(float) override;
+    void draw() override;
+
+private:
+
+    Preload& m_preload;
+    std::future<void> m_world;
+    bool m_assetsReady;
+    bool m_worldReady;
+    bool m_finished;
+};
@@ -0,0 +1,156 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <type_traits>
+
+// Asynchronous logging
+// LOG_INFO("Adding chunk at {},{}", x, y) copies the format pointer and arguments into the calling thread's ring,
+// a background writer does the formatting and I/O. Levels below LOG_MIN_LEVEL expand to nothing, so their
+// arguments aren't even evaluated. Set LOG_LEVEL in cmake to change it.
+
+#define LOG_LEVEL_DEBUG 0
+#define LOG_LEVEL_INFO 1
+#define LOG_LEVEL_WARNING 2
+#define LOG_LEVEL_ERROR 3
+
+#ifndef LOG_MIN_LEVEL
+#define LOG_MIN_LEVEL LOG_LEVEL_INFO
+#endif
+
+namespace Log
+{
+    enum class Level : std::uint8_t
+    {
+        Debug,
+        Info,
+        Warning,
+        Error
+    };
+
+    constexpr std::size_t MaxArgs(6);
+    constexpr std::size_t TextSize(64);     // Bytes shared by all string arguments of a message, longer strings are truncated
+    constexpr std::size_t RingSize(1024);   // Messages queued per thread before new ones are dropped
+
+    struct Arg
+    {
+        enum Type : std::uint8_t
+        {
+            Int,
+            UInt,
+            Float,
+            Bool,
+            Char,
+            Text
+        } type;
+
+        union
+        {
+            std::int64_t i;
+            std::uint64_t u;
+            double f;
+            struct
+            {
+                std::uint16_t offset;
+                std::uint16_t length;
+            } text;
+        };
+    };
+
+    struct Record
+    {
+        const char* format;
+        Level level;
+        std::uint8_t argCount;
+        std::uint16_t textUsed;
+        Arg args[MaxArgs];
+        char text[TextSize];
+    };
+
+    // Starts the writer thread, anything logged before this waits in the rings
+    void start();
+
+    // Writes out everything queued and stops the writer thread
+    void stop();
+
+    // Messages dropped because a thread's ring was full
+    std::uint64_t getDroppedCount();
+
+    namespace Detail
+    {
+        // Returns nullptr and counts a drop if the calling thread's ring is full
+        Record* beginRecord();
+        void commitRecord();
+
+        void packText(Record&, const char* str, std::size_t length);
+
+        inline void pack(Record& r, bool v) { auto& a = r.args[r.argCount++]; a.type = Arg::Bool; a.u = v; }
+        inline void pack(Record& r, char v) { auto& a = r.args[r.argCount++]; a.type = Arg::Char; a.i = v; }
+        inline void pack(Record& r, const char* v) { packText(r, v, std::char_traits<char>::length(v)); }
+        inline void pack(Record& r, const std::string& v) { packText(r, v.data(), v.size()); }
+
+        template<typename T>
+        typename std::enable_if<std::is_integral<T>::value && std::is_signed<T>::value>::type pack(Record& r, T v)
+        {
+            auto& a = r.args[r.argCount++]; a.type = Arg::Int; a.i = v;
+        }
+
+        template<typename T>
+        typename std::enable_if<std::is_integral<T>::value && std::is_unsigned<T>::value>::type pack(Record& r, T v)
+        {
+            auto& a = r.args[r.argCount++]; a.type = Arg::UInt; a.u = v;
+        }
+
+        template<typename T>
+        typename std::enable_if<std::is_floating_point<T>::value>::type pack(Record& r, T v)
+        {
+            auto& a = r.args[r.argCount++]; a.type = Arg::Float; a.f = v;
+        }
+    }
+
+    // Each {} in format is replaced by the next argument, format must be a string literal
+    template<typename... Args>
+    void write(Level level, const char* format, const Args&... args)
+    {
+        static_assert(sizeof...(Args) <= MaxArgs, "Too many log arguments");
+
+        auto record = Detail::beginRecord();
+        if (!record)
+            return;
+
+        record->format = format;
+        record->level = level;
+        record->argCount = 0;
+        record->textUsed = 0;
+
+        int expand[] = { 0, (Detail::pack(*record, args), 0)... };
+        (void)expand;
+
+        Detail::commitRecord();
+    }
+}
+
+#if LOG_MIN_LEVEL <= LOG_LEVEL_DEBUG
+#define LOG_DEBUG(...) Log::write(Log::Level::Debug, __VA_ARGS__)
+#else
+#define LOG_DEBUG(...) do {} while (false)
+#endif
+
+#if LOG_MIN_LEVEL <= LOG_LEVEL_INFO
+#define LOG_INFO(...) Log::write(Log::Level::Info, __VA_ARGS__)
+#else
+#define LOG_INFO(...) do {} while (false)
+#endif
+
+#if LOG_MIN_LEVEL <= LOG_LEVEL_WARNING
+#define LOG_WARNING(...) Log::write(Log::Level::Warning, __VA_ARGS__)
+#else
+#define LOG_WARNING(...) do {} while (false)
+#endif
+
+#if LOG_MIN_LEVEL <= LOG_LEVEL_ERROR
+#define LOG_ERROR(...) Log::write(Log::Level::Error, __VA_ARGS__)
+#else
+#define LOG_ERROR(...) do {} while (false)
+#endif
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <SFML/System/Vector2.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "TerrainChunk.hpp"
+
+class TileMap;
+
+// Handcrafted maps placed at fixed tiles in the generated world, filed by chunk
+// Each map is cut into a slice per chunk it overlaps when it's placed, laid out so stamping one over a freshly
+// generated chunk is a copy per row (or per layer where it spans the chunk) and a pass over the masks.
+// Chunks no stamp overlaps cost a single lookup.
+class MapStamps final
+{
+public:
+    // Places a map with its top left corner at a world tile, later stamps replace earlier ones across their whole rectangle
+    // Layers past OverlayLayers are dropped
+    void add(const TileMap&, sf::Vector2i tile);
+
+    bool overlaps(sf::Vector2i index) const;
+
+    // Stamps every slice in the chunk's area over a freshly generated chunk, in the order they were placed
+    // Tiles any layer covers become land
+    void applyTo(TerrainChunk&) const;
+
+    // True if the last stamp placed over the world tile draws on it, for tiles in chunks which aren't loaded
+    bool covers(int tileX, int tileY) const;
+
+    std::size_t size() const { return m_count; }
+
+private:
+
+    // The part of one map inside one chunk
+    struct Slice
+    {
+        int left = 0; // In tiles from the chunk's top left
+        int top = 0;
+        int width = 0;
+        int height = 0;
+
+        // OverlayLayers layers of width x height tiles, row-major, empty layers included so stamping
+        // overwrites whatever an earlier stamp left in the slot
+        std::vector<std::uint16_t> tiles;
+
+        // Full chunk masks, the tiles the map draws on and the whole rectangle
+        std::vector<std::uint64_t> covered;
+        std::vector<std::uint64_t> bounds;
+    };
+
+    std::unordered_map<std::int64_t, std::vector<Slice>> m_chunks;
+    std::size_t m_count = 0;
+};
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <xyginext/core/Message.hpp>
+
+#include <SFML/System/Vector2.hpp>
+
+enum Messages
+{
+    ChunkMessage = xy::Message::Count
+};
+
+// Posted by TerrainRenderer as chunks stream in and out
+struct ChunkEvent
+{
+    enum Type
+    {
+        Loaded,
+        Unloaded
+    } type;
+    sf::Vector2i index;
+};
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <SFML/Network/Packet.hpp>
+#include <SFML/Network/TcpSocket.hpp>
+
+#include <cstddef>
+#include <deque>
+
+// A non-blocking TCP connection which never drops or splits packets
+// Anything the socket won't take yet is queued and resent in order by flush()
+class NetConnection final
+{
+public:
+    NetConnection() = default;
+
+    NetConnection(const NetConnection&) = delete;
+    NetConnection& operator = (const NetConnection&) = delete;
+
+    // Connect or accept on this, it's made non-blocking by the first send or receive
+    sf::TcpSocket& getSocket() { return m_socket; }
+
+    // Queues a packet and sends as much of the queue as the socket takes
+    void send(const sf::Packet&);
+
+    // Sends as much of the queue as the socket takes, false once the connection has dropped
+    bool flush();
+
+    // Takes the next complete packet, false if there isn't one yet
+    bool receive(sf::Packet&);
+
+    bool isConnected() const { return m_connected; }
+
+    // Including the length prefix SFML puts on each packet
+    std::size_t getBytesSent() const { return m_bytesSent; }
+    std::size_t getBytesReceived() const { return m_bytesReceived; }
+
+private:
+
+    sf::TcpSocket m_socket;
+    std::deque<sf::Packet> m_outgoing;
+    bool m_connected = true;
+
+    std::size_t m_bytesSent = 0;
+    std::size_t m_bytesReceived = 0;
+};
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <SFML/Network/IpAddress.hpp>
+#include <SFML/Network/UdpSocket.hpp>
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+// Network conditions to simulate on top of a real socket, for testing over loopback
+struct LinkConditions
+{
+    float loss = 0.f;    // Chance of dropping each datagram, 0 to 1
+    float latency = 0.f; // Seconds each datagram is held back
+    float jitter = 0.f;  // Up to this many extra seconds, so datagrams also arrive out of order
+};
+
+// From --sim-loss, --sim-latency and --sim-jitter
+LinkConditions getSimulatedConditions();
+
+// A non-blocking UDP socket which applies LinkConditions to everything it sends
+class NetDatagrams final
+{
+public:
+    explicit NetDatagrams(const LinkConditions& = {});
+
+    NetDatagrams(const NetDatagrams&) = delete;
+    NetDatagrams& operator = (const NetDatagrams&) = delete;
+
+    // 0 for any free port
+    bool bind(unsigned short port);
+    unsigned short getLocalPort() const { return m_socket.getLocalPort(); }
+
+    void send(const std::vector<std::uint8_t>& data, const sf::IpAddress&, unsigned short port);
+
+    // Sends anything the simulated latency was holding back which is now due
+    void update();
+
+    // The next datagram, the data is only valid until the next call
+    bool receive(const std::uint8_t*& data, std::size_t& size, sf::IpAddress&, unsigned short& port);
+
+    std::size_t getBytesSent() const { return m_bytesSent; }
+
+private:
+
+    using Clock = std::chrono::steady_clock;
+
+    struct Delayed
+    {
+        Clock::time_point due;
+        std::vector<std::uint8_t> data;
+        sf::IpAddress address;
+        unsigned short port = 0;
+    };
+
+    sf::UdpSocket m_socket;
+    LinkConditions m_conditions;
+
+    std::mt19937 m_random;
+    std::vector<Delayed> m_delayed;
+
+    std::vector<std::uint8_t> m_receiveBuffer;
+    std::size_t m_bytesSent;
+};
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <SFML/Network/Packet.hpp>
+#include <SFML/System/Vector2.hpp>
+
+#include <cstddef>
+#include <cstdint>
+
+#include "TerrainEdits.hpp"
+#include "TerrainGenerator.hpp"
+
+// Port the server listens on unless given --port
+constexpr unsigned short DefaultPort(20715);
+
+// Bump whenever a packet's layout changes
+constexpr std::uint16_t ProtocolVersion(4);
+
+// Snapshots each end keeps to delta against, an acknowledgement older than this gets a full snapshot
+constexpr std::size_t SnapshotHistory(32);
+
+// First byte of every packet
+// Terrain is never sent as tiles, clients regenerate it from the world info and only edits cross the wire
+enum PacketID : std::uint8_t
+{
+    WorldInfoPacket,    // Server, on join: protocol version, client id, generator version, terrain params and their hash
+    ChunkRequestPacket, // Client, as each chunk loads: chunk index
+    ChunkInfoPacket,    // Server: chunk index, content hash, edit count then the edits
+    LandRequestPacket,  // Client, when its chunk doesn't match the content hash: chunk index
+    LandPacket,         // Server: chunk index then the land mask, with edits applied
+    TileEditPacket      // Server, to everyone as it's made: a single edit
+};
+
+// Unacknowledged inputs resent with every input datagram, so one getting through covers any lost before it
+constexpr std::size_t MaxInputsPerDatagram(32);
+
+// First 8 bits of every datagram, sent over UDP to the same port and bit packed
+// Snapshots are unreliable, each one is a delta against the newest the client has acknowledged
+enum DatagramID : std::uint8_t
+{
+    SnapshotDatagram, // Server, every step: sequence, whether there's a baseline, its sequence, the client's avatar id,
+                      // whether it's applied an input, the newest it has, then the snapshot
+    AckDatagram,      // Client, every frame: client id, whether it has a snapshot, the newest sequence it's received, its focus
+    InputDatagram     // Client, every frame: client id, newest input sequence, a count, then the unacknowledged inputs newest first
+};
+
+sf::Packet& operator << (sf::Packet&, sf::Vector2i);
+sf::Packet& operator >> (sf::Packet&, sf::Vector2i&);
+
+sf::Packet& operator << (sf::Packet&, const TileEdit&);
+sf::Packet& operator >> (sf::Packet&, TileEdit&);
+
+sf::Packet& operator << (sf::Packet&, const TerrainGenerator::Params&);
+sf::Packet& operator >> (sf::Packet&, TerrainGenerator::Params&);
+
+// sf::Packet only takes its own fixed width types, which std::uint64_t isn't on every platform
+void writeHash(sf::Packet&, std::uint64_t);
+std::uint64_t readHash(sf::Packet&);
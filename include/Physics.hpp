@@ -1,14 +1,45 @@
 #pragma once
 
+#include <SFML/System/Vector2.hpp>
+
 #include <xyginext/ecs/System.hpp>
 
+#include <cstddef>
+#include <unordered_map>
+#include <vector>
+
 class Physics : public xy::System
 {
 public:
-
     Physics(xy::MessageBus&);
+
     void process(float) override;
 
+    // Bodies' positions and velocities are kept here, packed for integration
+    // The Velocity component only seeds a body when it's added, change it afterwards through these
+    void setVelocity(xy::Entity, sf::Vector2f);
+    sf::Vector2f getVelocity(xy::Entity) const;
+
+    // Moves a body, setting its Transform's position directly is overwritten by the next process()
+    void setPosition(xy::Entity, sf::Vector2f);
+
+    // Moves bodies begin to end on by their velocities, process() splits this across workers
+    static void integrate(float* x, float* y, const float* vx, const float* vy, std::size_t begin, std::size_t end, float dt);
+
+    // Fewest bodies a worker thread is started for
+    static std::size_t getMinBodiesPerWorker();
+
 private:
 
-};
\ No newline at end of file
+    // Structure of arrays, index i is the same body in each
+    std::vector<xy::Entity> m_bodies;
+    std::vector<float> m_positionX;
+    std::vector<float> m_positionY;
+    std::vector<float> m_velocityX;
+    std::vector<float> m_velocityY;
+
+    std::unordered_map<xy::Entity::ID, std::size_t> m_bodyIndices;
+
+    void onEntityAdded(xy::Entity) override;
+    void onEntityRemoved(xy::Entity) override;
+};
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <array>
+
+#include <xyginext/ecs/System.hpp>
+
+#include "InputState.hpp"
+
+// Moves and animates every entity with an InputState
+class PlayerController : public xy::System
+{
+public:
+
+    PlayerController(xy::MessageBus&);
+    void process(float) override;
+
+    // The entity controlled by a local player, or a null entity if the slot is empty
+    xy::Entity getPlayer(Player player) const { return m_players[player]; }
+
+    // Where one step of movement takes an entity from position, before any collision
+    // Prediction replays inputs through this, so it has to stay the only place movement is worked out
+    static sf::Vector2f walk(sf::Vector2f position, sf::Vector2f movement, float dt);
+
+private:
+
+    std::array<xy::Entity, PlayerCount> m_players;
+
+    void onEntityAdded(xy::Entity) override;
+    void onEntityRemoved(xy::Entity) override;
+};
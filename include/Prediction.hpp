@@ -0,0 +1,87 @@
+#pragma once
+
+#include <SFML/System/Vector2.hpp>
+
+#include <xyginext/ecs/System.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+
+// One step of a player's movement, numbered so the server can say which it's applied
+// Quantised to what's sent, and the prediction moves by the quantised value too so both ends agree exactly
+struct InputFrame
+{
+    std::uint16_t sequence = 0;
+    std::int8_t x = 0; // Movement, -127 to 127 for -1 to 1
+    std::int8_t y = 0;
+};
+
+InputFrame quantiseInput(std::uint16_t sequence, sf::Vector2f movement);
+sf::Vector2f getMovement(const InputFrame&);
+
+// The inputs a client has predicted with but the server hasn't applied yet
+// Each is kept with where it moved from, so when the server's position for one arrives it can be compared
+// with what was predicted, and everything after it replayed from the server's position if they differ
+class InputHistory final
+{
+public:
+    InputHistory();
+
+    // Moves one step from a position with some movement
+    using Step = std::function<sf::Vector2f(sf::Vector2f position, sf::Vector2f movement)>;
+
+    // Numbers the next step's input, position is where it starts from
+    InputFrame record(sf::Vector2f movement, sf::Vector2f position);
+
+    // Drops everything up to and including acknowledged, where the server had the player afterwards
+    // If the prediction differs, current is replayed from there and true returned
+    bool reconcile(std::uint16_t acknowledged, sf::Vector2f authoritative, sf::Vector2f& current, const Step&);
+
+    // Oldest first
+    const std::deque<InputFrame>& getPending() const { return m_pending; }
+
+    void logStats() const;
+
+private:
+
+    std::deque<InputFrame> m_pending;
+    std::deque<sf::Vector2f> m_starts; // Where each pending input moved from
+    std::uint16_t m_sequence;
+    bool m_hasAcknowledged;
+    std::uint16_t m_acknowledged;
+
+    // For the correction and replay cost reported at the end
+    std::size_t m_recorded;
+    std::size_t m_reconciled;
+    std::size_t m_corrections;
+    double m_correctionTotal;
+    float m_correctionMax;
+    std::size_t m_replayedFrames;
+    double m_replayTime;
+    double m_replayTimeMax;
+};
+
+// Marks the player whose movement is predicted ahead of the server, added while joined to one
+struct Predicted final {};
+
+// Records every step's input for the predicted player before PlayerController moves it, and reconciles
+// it with the server's position as snapshots arrive, replaying through the same movement and collision
+class PredictionSystem final : public xy::System
+{
+public:
+    explicit PredictionSystem(xy::MessageBus&);
+    ~PredictionSystem();
+
+    void process(float) override;
+
+    void reconcile(std::uint16_t acknowledged, sf::Vector2f authoritative);
+
+    const InputHistory& getHistory() const { return m_history; }
+
+private:
+
+    InputHistory m_history;
+    float m_timestep;
+};
@@ -0,0 +1,60 @@
+#pragma once
+
+// Scoped timing markers, dumped as Chrome trace JSON (chrome://tracing or ui.perfetto.dev)
+// Configure with -DENABLE_PROFILER=ON to compile them in, otherwise the macros expand to nothing
+
+#ifdef ENABLE_PROFILER
+
+#include <chrono>
+#include <cstddef>
+#include <string>
+
+namespace Profiler
+{
+    using Clock = std::chrono::steady_clock;
+
+    // Events kept per thread, the oldest are overwritten once it's full
+    constexpr std::size_t RingSize(1 << 16);
+
+    // Records a complete event on the calling thread's ring
+    // name must outlive the profiler, only the pointer is stored
+    void record(const char* name, Clock::time_point start, Clock::time_point end);
+
+    // Names the calling thread's lane in the trace
+    void setThreadName(const std::string& name);
+
+    // Writes the events of every thread which has recorded any
+    bool writeTrace(const std::string& path);
+
+    class Scope final
+    {
+    public:
+        explicit Scope(const char* name) : m_name(name), m_start(Clock::now()) {}
+        ~Scope() { record(m_name, m_start, Clock::now()); }
+
+        Scope(const Scope&) = delete;
+        Scope& operator = (const Scope&) = delete;
+
+    private:
+        const char* m_name;
+        Clock::time_point m_start;
+    };
+}
+
+#define PROFILE_CONCAT_IMPL(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_IMPL(a, b)
+
+// Times the rest of the enclosing scope, name should be a string literal
+#define PROFILE_SCOPE(name) Profiler::Scope PROFILE_CONCAT(profileScope, __LINE__)(name)
+#define PROFILE_THREAD_NAME(name) Profiler::setThreadName(name)
+
+// Records an event between two Profiler::Clock time points, for spans which don't fit a scope
+#define PROFILE_EVENT(name, start, end) Profiler::record(name, start, end)
+
+#else
+
+#define PROFILE_SCOPE(name)
+#define PROFILE_THREAD_NAME(name)
+#define PROFILE_EVENT(name, start, end)
+
+#endif
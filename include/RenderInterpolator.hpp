@@ -0,0 +1,30 @@
+#pragma once
+
+#include <SFML/System/Vector2.hpp>
+
+#include <xyginext/ecs/System.hpp>
+
+// Added to anything which moves during the simulation step so it's drawn smoothly between steps
+struct Interpolated
+{
+    sf::Vector2f previous; // Position at the start of the latest step
+    sf::Vector2f current;  // Simulated position, held here while the drawn one is swapped in
+    bool snapToPixels = false; // Drawn at whole pixels too, for anything the simulation keeps on them
+};
+
+// Draws entities part way between their last two simulated positions
+// WorldState calls beginStep() before every simulation step, then apply()/restore() around drawing
+class RenderInterpolator final : public xy::System
+{
+public:
+    explicit RenderInterpolator(xy::MessageBus&);
+
+    void beginStep();
+
+    // alpha is how far the time not yet simulated is into the next step, 0 to 1
+    void apply(float alpha);
+    void restore();
+
+private:
+    void onEntityAdded(xy::Entity) override;
+};
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <SFML/Graphics/Vertex.hpp>
+#include <SFML/Graphics/View.hpp>
+
+#include <xyginext/ecs/System.hpp>
+
+#include <cstddef>
+#include <vector>
+
+#include "Input.hpp"
+#include "TerrainRenderer.hpp"
+
+namespace sf
+{
+    class RenderTarget;
+    class Texture;
+}
+
+// Everything needed to draw one frame, captured on the simulation thread and drawn on the render thread
+// Nothing in it refers back into the scene: the view is a copy, chunk meshes are held so they can't change
+// under it, and sprites are already transformed into quads. Textures are loaded up front and never change.
+struct RenderSnapshot final
+{
+    // Consecutive sprite quads sharing a texture, drawn in one call
+    struct SpriteBatch
+    {
+        const sf::Texture* texture = nullptr;
+        std::size_t first = 0;
+        std::size_t count = 0; // Vertices
+    };
+
+    sf::View view;
+    const sf::Texture* terrainTexture = nullptr;
+    std::vector<TerrainRenderer::Mesh> chunks;
+    std::vector<sf::Vertex> sprites;
+    std::vector<SpriteBatch> batches;
+
+    // The oldest input applied in the steps it was captured after, for the latency until it's drawn
+    bool hasInput = false;
+    InputEvent::Clock::time_point inputTime;
+
+    // Terrain first, then sprites in the order they were captured, as the scene itself draws them
+    void draw(sf::RenderTarget&) const;
+};
+
+// Fills a render snapshot from the scene, for when the scene is stepped on another thread to the one drawing
+class RenderCapture final : public xy::System
+{
+public:
+    explicit RenderCapture(xy::MessageBus&);
+
+    // Replaces the snapshot's contents with the active camera's view, the chunks it overlaps and every sprite
+    // Vectors keep their capacity, so reusing a snapshot doesn't allocate once it's grown to fit a frame
+    void capture(RenderSnapshot&);
+};
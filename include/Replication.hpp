@@ -0,0 +1,35 @@
+#pragma once
+
+#include <SFML/System/Vector2.hpp>
+
+#include <xyginext/ecs/System.hpp>
+
+#include <cstdint>
+
+#include "Snapshot.hpp"
+
+// Added to anything whose position, velocity and animation are sent to clients
+struct Replicated
+{
+    std::uint32_t id = 0;       // Assigned by ReplicationSystem, never reused
+    sf::Vector2f lastPosition;  // Position at the end of the previous step, velocity is taken from it
+};
+
+// Captures every replicated entity into a snapshot at the end of each step, for WorldServer to send
+class ReplicationSystem final : public xy::System
+{
+public:
+    explicit ReplicationSystem(xy::MessageBus&);
+
+    void process(float) override;
+
+    // Sorted by id, sequence counts up once per step
+    const Snapshot& getSnapshot() const { return m_snapshot; }
+
+private:
+
+    std::uint32_t m_nextID;
+    Snapshot m_snapshot;
+
+    void onEntityAdded(xy::Entity) override;
+};
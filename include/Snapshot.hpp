@@ -0,0 +1,67 @@
+#pragma once
+
+#include <SFML/System/Vector2.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "BitStream.hpp"
+#include "TerrainChunk.hpp"
+
+// Positions are stored as 16 bits across a chunk, 1/32 of a world unit
+constexpr float PositionScale(65536.f / (ChunkSize * TileSize));
+
+// Velocities are 1/16 of a world unit per second, up to 2048 each way
+constexpr float VelocityScale(16.f);
+
+// Snapshots are cut off at this size so they never fragment, whatever doesn't fit goes in a later one
+constexpr std::size_t MaxDatagramSize(1200);
+
+// One replicated entity, quantised
+struct EntitySnapshot
+{
+    std::uint32_t id = 0;
+    sf::Vector2i chunk;
+    std::uint16_t x = 0; // Relative to the chunk's origin
+    std::uint16_t y = 0;
+    std::int16_t velocityX = 0;
+    std::int16_t velocityY = 0;
+    std::uint8_t animation = 0; // Animation index in the low 7 bits, the top bit set while it's playing
+};
+
+// The replicated entities at one tick, sorted by id
+struct Snapshot
+{
+    std::uint16_t sequence = 0;
+    std::vector<EntitySnapshot> entities;
+};
+
+EntitySnapshot quantise(std::uint32_t id, sf::Vector2f position, sf::Vector2f velocity, std::uint8_t animation);
+sf::Vector2f getPosition(const EntitySnapshot&);
+sf::Vector2f getVelocity(const EntitySnapshot&);
+
+// Writes every entity which differs from the baseline, an empty baseline for a full snapshot
+// Unchanged entities cost nothing, changed fields are sent as deltas and removed entities as their id
+// Anything which would take the writer past maxBytes is left out, visible gets what the reader will rebuild,
+// which is what later deltas have to be taken against once it's acknowledged
+// Returns how many entities were left out
+std::size_t writeSnapshot(BitWriter&, const Snapshot& current, const Snapshot& baseline, std::size_t maxBytes, Snapshot& visible);
+
+// Bits writeSnapshot() spends on an entity, besides its id, base is null for an entity new since the baseline
+std::size_t measureEntity(const EntitySnapshot&, const EntitySnapshot* base);
+
+bool sameState(const EntitySnapshot&, const EntitySnapshot&);
+
+// A position as a chunk index and 16 bits across it on each axis, for anything else which sends positions
+void writePosition(BitWriter&, sf::Vector2f);
+sf::Vector2f readPosition(BitReader&);
+
+// Rebuilds a snapshot written against the same baseline, false if the data is malformed
+bool readSnapshot(BitReader&, const Snapshot& baseline, Snapshot& out);
+
+// True if sequence a is after b, allowing for wrap around
+inline bool isNewer(std::uint16_t a, std::uint16_t b)
+{
+    return static_cast<std::int16_t>(a - b) > 0;
+}
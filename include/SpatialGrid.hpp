@@ -0,0 +1,86 @@
+#pragma once
+
+#include <SFML/Graphics/Rect.hpp>
+#include <SFML/System/Vector2.hpp>
+
+#include <xyginext/ecs/System.hpp>
+
+#include <array>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "TerrainChunk.hpp"
+
+// Broadphase cells are square runs of tiles, a whole number of them to a chunk
+constexpr int GridCellTiles(8);
+constexpr int GridCellsPerChunk(ChunkSize / GridCellTiles);
+constexpr float GridCellSize(GridCellTiles * TileSize);
+static_assert(ChunkSize % GridCellTiles == 0, "Grid cells must tile a chunk exactly");
+
+// Uniform grid of every Collider, bucketed by the chunk each cell falls in
+// Entities are filed by the centre of their bounds and only move bucket when that crosses a cell edge
+// Queries append to a caller's buffer so they don't allocate once it's grown
+class SpatialGrid final : public xy::System
+{
+public:
+    explicit SpatialGrid(xy::MessageBus&);
+
+    void process(float) override;
+
+    // Entities whose bounds overlap, returns how many were appended to out
+    std::size_t queryArea(const sf::FloatRect& area, std::vector<xy::Entity>& out) const;
+    std::size_t queryRadius(sf::Vector2f centre, float radius, std::vector<xy::Entity>& out) const;
+
+    // Batched versions, the results for query i are out[offsets[i]] to out[offsets[i + 1]]
+    void queryAreas(const std::vector<sf::FloatRect>& areas, std::vector<xy::Entity>& out, std::vector<std::size_t>& offsets) const;
+    void queryRadii(const std::vector<sf::Vector2f>& centres, float radius, std::vector<xy::Entity>& out, std::vector<std::size_t>& offsets) const;
+
+    // Every entity filed in a chunk, so they can be streamed with it
+    std::size_t getChunkEntities(sf::Vector2i chunk, std::vector<xy::Entity>& out) const;
+
+    // The chunk an entity with a Collider is filed in, by the centre of its bounds
+    // Anything deciding which chunk owns an entity goes by this so it agrees with getChunkEntities()
+    static sf::Vector2i getChunk(xy::Entity);
+
+private:
+
+    struct Item
+    {
+        xy::Entity entity;
+        sf::FloatRect bounds;
+    };
+
+    struct ChunkCells
+    {
+        std::array<std::vector<Item>, GridCellsPerChunk * GridCellsPerChunk> cells;
+        std::size_t count = 0;
+    };
+
+    // Where each entity is filed, the chunk's cells directly so an entity staying in its cell costs no lookups
+    // Map nodes don't move, and a chunk is only erased once nothing is filed in it
+    struct Location
+    {
+        ChunkCells* chunk = nullptr;
+        sf::Vector2i cell;
+        std::size_t slot = 0;
+    };
+
+    std::unordered_map<std::int64_t, ChunkCells> m_chunks;
+    std::vector<Location> m_locations; // By entity index
+
+    // Largest half size any bounds have had, queries widen by this since entities are filed by their centre
+    // Raised whenever bounds are read, so colliders which grow are still found
+    sf::Vector2f m_maxHalfSize;
+    void fitHalfSize(const sf::FloatRect&);
+
+    void onEntityAdded(xy::Entity) override;
+    void onEntityRemoved(xy::Entity) override;
+
+    static sf::FloatRect getBounds(xy::Entity);
+    void insert(const Item&, sf::Vector2i cell);
+    void remove(Location&);
+
+    template<typename Test>
+    std::size_t query(const sf::FloatRect& area, std::vector<xy::Entity>& out, Test&& test) const;
+};
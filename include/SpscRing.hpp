@@ -0,0 +1,55 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+
+// Fixed size lock-free queue for exactly one producer thread and one consumer thread
+template<typename T, std::size_t Size>
+class SpscRing final
+{
+    static_assert(Size > 0 && (Size & (Size - 1)) == 0, "SpscRing size must be a power of two");
+
+public:
+
+    // Producer only, returns false if the ring is full
+    bool push(const T& item)
+    {
+        auto head = m_head.load(std::memory_order_relaxed);
+        if (head - m_tail.load(std::memory_order_acquire) == Size)
+            return false;
+
+        m_items[head & (Size - 1)] = item;
+        m_head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer only, returns false if the ring is empty
+    bool pop(T& item)
+    {
+        auto tail = m_tail.load(std::memory_order_relaxed);
+        if (tail == m_head.load(std::memory_order_acquire))
+            return false;
+
+        item = m_items[tail & (Size - 1)];
+        m_tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Approximate when called while the other side is active
+    std::size_t size() const
+    {
+        return m_head.load(std::memory_order_acquire) - m_tail.load(std::memory_order_acquire);
+    }
+
+private:
+
+    std::array<T, Size> m_items;
+
+    // Padded onto separate cache lines so the two sides don't contend
+    // (padding rather than alignas, as C++14 new ignores over-alignment)
+    char m_padding0[64];
+    std::atomic<std::size_t> m_head{ 0 };
+    char m_padding1[64];
+    std::atomic<std::size_t> m_tail{ 0 };
+};
@@ -2,5 +2,6 @@
 
 enum States
 {
-    WorldPlayState
+    WorldPlayState,
+    WorldLoadState
 };
\ No newline at end of file
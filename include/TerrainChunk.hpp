@@ -1,43 +1,96 @@
 #pragma once
 
-#include <array>
+#include <cmath>
+#include <cstdint>
+#include <vector>
 
-#include "FastNoise.h"
+#include <SFML/System/Vector2.hpp>
 
 constexpr int ChunkSize(128); 
 constexpr int TileCount(ChunkSize*ChunkSize);
 constexpr int TileSize(16.f); // tile size in pixels
 constexpr float SeaLevel(0.f); // range -1.0 to 1.0
+constexpr int OverlayLayers(6); // Tile layers a stamped map can draw over the generated terrain
 
-struct TerrainData
+// Integer division rounding towards negative infinity, for tile and chunk indices left of or above the origin
+inline int floorDiv(int value, int divisor)
 {
-    float height;
+    return value >= 0 ? value / divisor : (value + 1) / divisor - 1;
+}
+
+// Index of the chunk containing a world position
+inline sf::Vector2i chunkAt(sf::Vector2f worldPos)
+{
+    return { floorDiv(static_cast<int>(std::floor(worldPos.x / TileSize)), ChunkSize),
+        floorDiv(static_cast<int>(std::floor(worldPos.y / TileSize)), ChunkSize) };
+}
+
+// Packs a chunk index into a single key for maps of chunks
+inline std::int64_t chunkKey(sf::Vector2i index)
+{
+    return (static_cast<std::int64_t>(index.x) << 32) | static_cast<std::uint32_t>(index.y);
+}
+
+enum class Biome : std::uint8_t
+{
+    Ocean,
+    Beach,
+    Desert,
+    Grassland,
+    Forest,
+    Rainforest,
+    Tundra,
+    Taiga,
+    Snow,
+    Count
 };
 
+// Struct-of-arrays so each pass over a chunk only streams the layers it reads
+// Filled by TerrainGenerator::generate
 struct TerrainChunk
 {
-    TerrainChunk() :
-        data{ {0u} }
-    {};
+    sf::Vector2i getIndex() const { return m_index; };
+    void setIndex(sf::Vector2i index) { m_index = index; }
 
-    void generate(FastNoise& noise, sf::Vector2i index)
+    // Sizes every layer for a full chunk, does nothing once they're sized
+    void allocate()
     {
-        m_index = index;
-        for (int y(0); y < ChunkSize; y++)
-        {
-            for (int x(0); x < ChunkSize; x++)
-            {
-                auto n = noise.GetSimplexFractal(index.x * ChunkSize + x, index.y * ChunkSize +  y);
-
-                data[y * ChunkSize + x].height = n;
-            }
-        }   
+        height.resize(TileCount);
+        moisture.resize(TileCount);
+        temperature.resize(TileCount);
+        region.resize(TileCount);
+        biome.resize(TileCount);
+        land.resize(TileCount / 64);
+        stamped.resize(TileCount / 64);
     }
 
-    sf::Vector2i getIndex() const { return m_index; };
+    std::vector<float> height;      // range -1.0 to 1.0
+    std::vector<float> moisture;    // range -1.0 to 1.0
+    std::vector<float> temperature; // range -1.0 to 1.0
+    std::vector<float> region;      // range -1.0 to 1.0, constant across each cellular region
+    std::vector<Biome> biome;
 
-    std::array<TerrainData, TileCount> data;
+    // One bit per tile, set where height is above SeaLevel, for collision queries
+    std::vector<std::uint64_t> land;
+    bool isLand(int x, int y) const
+    {
+        int i = y * ChunkSize + x;
+        return (land[i >> 6] >> (i & 63)) & 1;
+    }
+
+    // One bit per tile drawn from the overlay, set by MapStamps::applyTo and cleared again by edits
+    // The overlay is OverlayLayers layers of TileCount tiles, 0 for none, otherwise 1 + the tile's index in the sheet.
+    // It's only sized once a stamp touches the chunk and only read where stamped is set, so stale tiles are harmless.
+    std::vector<std::uint64_t> stamped;
+    std::vector<std::uint16_t> overlay;
+    bool isStamped(int i) const
+    {
+        return (stamped[i >> 6] >> (i & 63)) & 1;
+    }
+
+    // TerrainGenerator::hashChunk of the chunk as generated, before any edits or stamps
+    std::uint64_t contentHash = 0;
 
 private:
     sf::Vector2i m_index;
-};
\ No newline at end of file
+};
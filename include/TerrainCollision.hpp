@@ -0,0 +1,37 @@
+#pragma once
+
+#include <SFML/Graphics/Rect.hpp>
+#include <SFML/System/Vector2.hpp>
+
+#include <xyginext/ecs/System.hpp>
+
+#include <unordered_map>
+
+class TerrainRenderer;
+struct TerrainChunk;
+
+// Stops colliders moving onto sea tiles
+// Runs after everything which moves them, sweeping each body from where it was last resolved to where it's
+// been moved, one axis at a time, and pushing it back against the first sea tile it would enter
+// Only resident chunks are tested, tiles in chunks which aren't loaded yet are treated as passable, so the server
+// keeps chunks resident around every client's avatar
+class TerrainCollision final : public xy::System
+{
+public:
+    explicit TerrainCollision(xy::MessageBus&);
+
+    void process(float) override;
+
+    // Where a box with the given bounds moving from one position to another stops, against what's loaded now
+    sf::Vector2f resolve(sf::Vector2f from, sf::Vector2f to, const sf::FloatRect& bounds);
+
+    // Takes a body's current position as resolved, for entities moved somewhere new rather than along a path
+    void resetBody(xy::Entity);
+
+private:
+    // Position each body was left at by the last process()
+    std::unordered_map<xy::Entity::ID, sf::Vector2f> m_resolved;
+
+    void onEntityAdded(xy::Entity) override;
+    void onEntityRemoved(xy::Entity) override;
+};
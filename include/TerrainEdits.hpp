@@ -0,0 +1,41 @@
+#pragma once
+
+#include <SFML/System/Vector2.hpp>
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "TerrainChunk.hpp"
+
+// A tile changed from whatever the generator made it, the only terrain which is ever sent over the network
+struct TileEdit
+{
+    std::int32_t x = 0; // World tile
+    std::int32_t y = 0;
+    bool land = false;
+};
+
+// Every edit made to the world, filed by chunk so loading a chunk only looks at its own
+class TerrainEdits final
+{
+public:
+    // Records an edit, replacing any earlier one to the same tile, and returns the chunk it's in
+    sf::Vector2i add(const TileEdit&);
+
+    // The edits in one chunk, in the order they were first made
+    const std::vector<TileEdit>& getChunkEdits(sf::Vector2i index) const;
+
+    // Applies every edit in the chunk's area to a freshly generated chunk
+    void applyTo(TerrainChunk&) const;
+
+    std::size_t size() const { return m_count; }
+
+    // Overwrites a single tile of a chunk, which must contain it
+    static void apply(TerrainChunk&, const TileEdit&);
+
+private:
+
+    std::unordered_map<std::int64_t, std::vector<TileEdit>> m_chunks;
+    std::size_t m_count = 0;
+};
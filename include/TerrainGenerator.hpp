@@ -0,0 +1,99 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include <SFML/System/Vector2.hpp>
+
+#include "FastNoise.h"
+#include "TerrainChunk.hpp"
+
+// Number of steps each of moisture and temperature is quantised to for the biome lookup
+constexpr int BiomeSteps(8);
+
+// Chunks are generated in float relative to their origin tile, which keeps tile precision at any distance
+typedef FastNoiseT<float> TerrainNoise;
+
+class TerrainGenerator
+{
+public:
+
+    enum Layer
+    {
+        Height,
+        Moisture,
+        Temperature,
+        Region,
+        LayerCount
+    };
+
+    // Bump whenever generate() would produce different output for the same parameters,
+    // clients refuse to join a server whose generator doesn't match theirs
+    static constexpr std::uint32_t Version = 1;
+
+    struct NoiseParams
+    {
+        float frequency;
+        std::int32_t octaves;
+        float lacunarity;
+        float gain;
+        float cellularJitter;
+        std::uint8_t noiseType;
+        std::uint8_t fractalType;
+        std::uint8_t interp;
+        std::uint8_t cellularDistance;
+        std::uint8_t cellularReturn;
+    };
+
+    // Everything a world's terrain depends on besides the generator code itself,
+    // enough for another machine to regenerate it tile for tile
+    struct Params
+    {
+        std::int32_t seed;
+        std::array<NoiseParams, LayerCount> layers;
+    };
+
+    // The parameters every local world uses
+    static Params defaultParams(int seed);
+
+    // False for parameters the generator can't safely run with, such as more octaves than FastNoise has room for
+    // The hash only shows they arrived as they were sent, anything from the network is checked with this too
+    static bool isSane(const Params&);
+
+    // Identifies the terrain the parameters produce with this version of the generator
+    static std::uint64_t hashParams(const Params&);
+
+    // Hashes a generated chunk's biomes and land mask, what clients compare against the server's to verify their output
+    static std::uint64_t hashChunk(const TerrainChunk&);
+
+    explicit TerrainGenerator(int seed = 1337);
+    explicit TerrainGenerator(const Params&);
+
+    // Fills every layer of the chunk at the given chunk index, classifies its biomes and sets its content hash
+    void generate(TerrainChunk&, sf::Vector2i index) const;
+
+    // Height at a single tile, for lookups outside of a generated chunk
+    // Evaluated relative to the owning chunk's origin so it matches the generated chunk exactly
+    float getHeight(int tileX, int tileY) const;
+
+    // Picks one of count decorative variants for a tile, stable for a given seed so replays draw identically
+    int getVariant(int tileX, int tileY, int count) const;
+
+    const TerrainNoise& getLayer(Layer layer) const { return m_layers[layer]; }
+    const Params& getParams() const { return m_params; }
+
+private:
+
+    Params m_params;
+
+    std::array<TerrainNoise, LayerCount> m_layers;
+
+    // Layers which sample the same lattice and are evaluated together
+    std::vector<std::vector<Layer>> m_fusedGroups;
+
+    // Height band * moisture step * temperature step
+    std::array<Biome, 3 * BiomeSteps * BiomeSteps> m_biomeTable;
+
+    void buildBiomeTable();
+};
@@ -1,47 +1,120 @@
 #pragma once
 
-#include <array>
-#include <unordered_map>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <vector>
+#include <SFML/Graphics/VertexArray.hpp>
 #include <xyginext/ecs/System.hpp>
-#include <xyginext/resources/Resource.hpp>
 
-#include "FastNoise.h"
+#include "MapStamps.hpp"
 #include "TerrainChunk.hpp"
+#include "TerrainEdits.hpp"
+#include "TerrainGenerator.hpp"
+
+// Draw distance (radius from camera, in world units)
+constexpr float DrawDistance(3500.f);
+
+// Chunks kept loaded are the 3x3 around each focus plus any whose centre is still within the draw distance of one,
+// this many slots covers every chunk in that radius of a single focus
+constexpr int StreamRadius(static_cast<int>(DrawDistance / (ChunkSize * TileSize)) + 1);
+constexpr int ChunkPoolSize((2 * StreamRadius + 1) * (2 * StreamRadius + 1));
+
+namespace sf
+{
+    class Texture;
+}
 
 class TerrainRenderer : public xy::System, public sf::Drawable
 {
 public:
-    TerrainRenderer(xy::MessageBus&);
+    // Headless terrain streams and generates chunks as usual but never meshes or draws them
+    TerrainRenderer(xy::MessageBus&, const TerrainGenerator::Params&, bool headless = false);
     void process(float) override;
 
-    // Probably the wrong place for this...
-    bool isLand(sf::Vector2f worldPos)
-    {
-        return m_noise.GetSimplexFractal(worldPos.x / TileSize, worldPos.y / TileSize) > SeaLevel;
-    }
+    // Points chunks are streamed around as well as the camera, for a server keeping every client's surroundings
+    // loaded so collision there matches what the client sees. The pool grows by a camera's worth for each.
+    void setFocuses(const std::vector<sf::Vector2f>& focuses) { m_focuses = focuses; }
+
+    // Reads the resident chunk's land mask, only evaluating the noise and stamps if the chunk isn't loaded
+    bool isLand(sf::Vector2f worldPos) const;
+
+    // The loaded chunk at a chunk index, or nullptr if it isn't resident
+    // Only valid until the chunk is unloaded, don't hold on to it
+    const TerrainChunk* getChunk(sf::Vector2i index) const;
+
+    const TerrainGenerator& getGenerator() const { return m_generator; }
+    const TerrainEdits& getEdits() const { return m_edits; }
+    const MapStamps& getStamps() const { return m_stamps; }
+
+    // Places a handcrafted map over the generated terrain with its top left corner at a world tile
+    // Only chunks loaded after it's placed are stamped, so place everything before the first process
+    void addStamp(const TileMap& map, sf::Vector2i tile) { m_stamps.add(map, tile); }
+
+    // Records an edit and applies it to the chunk straight away if it's loaded, it's remeshed on the next process
+    // Sea edges drawn in neighbouring chunks still follow the generated coastline
+    void editTile(const TileEdit&);
+
+    // Takes a chunk generated ahead of time from the same parameters, as if it had streamed in, unless its index is
+    // already loaded. Its storage is swapped with a free slot's, so the chunk passed in is left with the slot's old storage.
+    void adoptChunk(TerrainChunk&);
+
+    // Overwrites a loaded chunk's land mask with one from elsewhere, for when the local generator disagrees with the server
+    void replaceLand(sf::Vector2i index, const std::vector<std::uint64_t>& land);
+
+    // Meshes of the loaded chunks overlapping area, for drawing on another thread
+    // A mesh is never changed while anything else holds it, remeshing moves the chunk to another
+    using Mesh = std::shared_ptr<const sf::VertexArray>;
+    void getVisibleMeshes(const sf::FloatRect& area, std::vector<Mesh>& meshes) const;
+
+    // The tile sheet chunks are drawn with, loaded by whatever owns the window
+    void setTexture(const sf::Texture& texture) { m_sheetTexture = &texture; }
+    const sf::Texture* getTexture() const { return m_sheetTexture; }
 
 private:
 
-    // Use this to cache bounds as it's pretty inefficient calculating
-    struct ChunkData
+    // A reusable chunk, its storage is overwritten in place each time it's given a new index
+    struct ChunkSlot
     {
-        sf::VertexArray verts;
+        TerrainChunk chunk;
+        std::shared_ptr<sf::VertexArray> mesh;
         sf::FloatRect bounds;
+        bool active = false;
+        bool dirty = false; // Edited since it was meshed
     };
 
-    // One vert array per chunk
-    std::unordered_map<xy::Entity::ID,ChunkData> m_drawList;
+    TerrainGenerator m_generator;
+    TerrainEdits m_edits;
+    MapStamps m_stamps;
 
-    void onEntityAdded(xy::Entity) override;
-    void onEntityRemoved(xy::Entity) override;
+    // ChunkPoolSize slots to begin with, a deque so growing it doesn't move any
+    std::deque<ChunkSlot> m_slots;
 
-    void draw(sf::RenderTarget&, sf::RenderStates) const override;
+    // Active slots by chunk index, open addressed and kept at most half full so streaming never allocates
+    // Only resized when the pool grows, a power of two
+    std::vector<ChunkSlot*> m_resident;
+
+    std::vector<sf::Vector2f> m_focuses;
+    std::vector<sf::Vector2f> m_streamFocuses; // The camera then m_focuses, for the current process()
 
-    xy::Entity addChunk(sf::Vector2i index);
+    // Meshes replaced while a render snapshot still held them, reused once it's let go
+    std::vector<std::shared_ptr<sf::VertexArray>> m_spareMeshes;
+    std::shared_ptr<sf::VertexArray> takeMesh();
+
+    void draw(sf::RenderTarget&, sf::RenderStates) const override;
 
-    FastNoise m_noise;
+    ChunkSlot* findSlot(sf::Vector2i index);
+    ChunkSlot& addChunk(sf::Vector2i index);
+    ChunkSlot& freeSlot(sf::Vector2i index);
+    ChunkSlot& addSlot();
+    ChunkSlot* findResident(sf::Vector2i index) const;
+    void insertResident(ChunkSlot&);
+    void eraseResident(const ChunkSlot&);
+    bool isWanted(const ChunkSlot&) const;
+    void activate(ChunkSlot&);
+    void releaseChunk(ChunkSlot&);
+    void meshChunk(ChunkSlot&);
 
-    sf::Texture* m_sheetTexture;
-    xy::TextureResource m_textures;
-    xy::Entity m_currentChunk; // The current "center" chunk
+    bool m_headless;
+    const sf::Texture* m_sheetTexture;
 };
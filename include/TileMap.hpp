@@ -0,0 +1,49 @@
+#pragma once
+
+#include <SFML/System/Vector2.hpp>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "TerrainChunk.hpp"
+
+// One chunk-sized piece of a map, laid out like TerrainChunk so it can be copied over one a row at a time
+// Pieces at the map's right and bottom edges are padded out to the full chunk with empty tiles
+struct MapPiece
+{
+    sf::Vector2i index; // In chunks from the map's top left
+
+    // ChunkSize x ChunkSize tiles per layer, row-major, 0 where the layer is empty,
+    // otherwise 1 + the tile's index in the tile sheet counting across then down
+    std::vector<std::vector<std::uint16_t>> layers;
+
+    // One bit per tile where any layer has a tile, packed like TerrainChunk::land
+    std::vector<std::uint64_t> covered;
+};
+
+// A handcrafted Tiled map, cut into chunk-sized pieces for stamping into the generated world
+// Only orthogonal maps with 16px tiles from a single tile sheet are supported, tile layers encoded as base64
+// (optionally zlib or gzip compressed). Object layers and anything else are skipped.
+class TileMap final
+{
+public:
+    // Streams the file, handing each layer's data to a worker to decode and cut up as soon as it's been read,
+    // so decoding overlaps reading the rest. False if the file can't be read or any layer fails to decode.
+    bool loadFromFile(const std::string& path);
+
+    sf::Vector2i getSize() const { return m_size; } // In tiles
+    sf::Vector2i getChunkCount() const { return m_chunkCount; }
+    const std::vector<std::string>& getLayerNames() const { return m_layerNames; }
+
+    // Sorted by row then column, one for every chunk the map overlaps
+    const std::vector<MapPiece>& getPieces() const { return m_pieces; }
+    const MapPiece* getPiece(sf::Vector2i index) const;
+
+private:
+
+    sf::Vector2i m_size;
+    sf::Vector2i m_chunkCount;
+    std::vector<std::string> m_layerNames;
+    std::vector<MapPiece> m_pieces;
+};
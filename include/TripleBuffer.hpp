@@ -0,0 +1,54 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+
+// Hands the latest of a stream of values from one producer thread to one consumer thread without either waiting
+// The producer always has a slot to fill and the consumer always has the newest complete one to read,
+// the third sits between them. Values the consumer doesn't get to in time are simply replaced.
+template<typename T>
+class TripleBuffer final
+{
+public:
+
+    // Producer only, the slot to fill, it still holds whatever was in it last time round
+    T& getWriteBuffer() { return m_buffers[m_write]; }
+
+    // Producer only, hands over the filled slot, replacing one the consumer hasn't taken yet
+    void publish()
+    {
+        auto previous = m_middle.exchange(m_write | FreshBit, std::memory_order_acq_rel);
+        m_write = previous & IndexMask;
+    }
+
+    // Consumer only, takes the newest published slot, false if there's been nothing new since the last
+    bool acquire()
+    {
+        if (!(m_middle.load(std::memory_order_relaxed) & FreshBit))
+            return false;
+
+        auto previous = m_middle.exchange(m_read, std::memory_order_acq_rel);
+        m_read = previous & IndexMask;
+        return true;
+    }
+
+    // Consumer only, the slot taken by the last successful acquire()
+    const T& getReadBuffer() const { return m_buffers[m_read]; }
+
+    // True until the consumer takes the newest slot, so the producer can tell it's been used
+    bool isFresh() const { return (m_middle.load(std::memory_order_acquire) & FreshBit) != 0; }
+
+private:
+
+    static constexpr unsigned IndexMask = 3;
+    static constexpr unsigned FreshBit = 4;
+
+    std::array<T, 3> m_buffers;
+
+    // Padded onto separate cache lines as each end is only touched by its own thread
+    unsigned m_write = 0;
+    char m_padding0[64];
+    std::atomic<unsigned> m_middle{ 1 };
+    char m_padding1[64];
+    unsigned m_read = 2;
+};
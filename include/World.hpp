@@ -0,0 +1,59 @@
+#pragma once
+
+#include <xyginext/ecs/Scene.hpp>
+
+#include "InputState.hpp"
+#include "TerrainGenerator.hpp"
+
+class InputDirector;
+class RenderInterpolator;
+
+// The simulated world, a scene with every system which doesn't need a window, stepped at a fixed rate
+// WorldState adds drawing on top of it, the headless server runs it on its own
+class World final
+{
+public:
+    // Headless worlds skip anything which needs a graphics context, like terrain meshes and textures
+    // Worlds joined to a server pass its terrain parameters, otherwise they're made from --seed
+    World(xy::MessageBus&, bool headless, const TerrainGenerator::Params* terrain = nullptr);
+    ~World();
+
+    World(const World&) = delete;
+    World& operator = (const World&) = delete;
+
+    void handleEvent(const sf::Event&);
+    void handleMessage(const xy::Message&);
+
+    // Runs as many fixed steps as the accumulated time covers, returns how many ran
+    int update(float dt);
+
+    // How far the time not yet simulated is into the next step, 0 to 1
+    float getInterpolation() const { return m_accumulator / m_timestep; }
+    float getTimestep() const { return m_timestep; }
+
+    // False once a playback has run out
+    bool isRunning() const;
+
+    // A character like the player's for a remote player to control, moved by its InputState
+    xy::Entity spawnAvatar();
+
+    // Adds wandering, replicated entities scattered around the origin, for loading a server
+    void spawnBots(int count);
+
+    xy::Scene& getScene() { return m_scene; }
+    xy::Entity getPlayer() const { return m_player; }
+    InputDirector& getInput() { return *m_input; }
+    RenderInterpolator& getInterpolator() { return *m_interpolator; }
+
+private:
+
+    xy::Scene m_scene;
+    xy::Entity m_player;
+    InputDirector* m_input;
+    RenderInterpolator* m_interpolator;
+
+    float m_timestep;
+    float m_accumulator;
+
+    xy::Entity createCharacter(Player);
+};
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <SFML/Network/IpAddress.hpp>
+#include <SFML/Network/Packet.hpp>
+
+#include <xyginext/ecs/Entity.hpp>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "NetConnection.hpp"
+#include "NetDatagrams.hpp"
+#include "NetProtocol.hpp"
+#include "Snapshot.hpp"
+#include "TerrainGenerator.hpp"
+
+namespace xy
+{
+    class Message;
+}
+
+class TerrainRenderer;
+class World;
+
+// Joins a WorldServer and keeps the local world in step with it
+// Chunks are generated locally from the server's parameters, checked against its content hashes,
+// and only the edits made to them are received. Entities arrive as snapshots and are mirrored into the scene,
+// smoothed between snapshots by xy::NetInterpolate. The local player is the exception, it's predicted from
+// local input, which is sent to move its avatar on the server, and reconciled as the server's positions arrive.
+class WorldClient final
+{
+public:
+    explicit WorldClient(const LinkConditions& = {});
+
+    // Connects and waits for the world info, false if the server can't be reached or generates terrain differently
+    bool join(const std::string& address, unsigned short port);
+
+    // The terrain parameters the server sent, build the world with these
+    const TerrainGenerator::Params& getParams() const { return m_params; }
+
+    // Called on each entity created for the server's, after its Transform, SpriteAnimation and NetInterpolate are added
+    using SpawnCallback = std::function<void(xy::Entity)>;
+    void setSpawnCallback(SpawnCallback callback) { m_spawnCallback = callback; }
+
+    // Called on every snapshot as it's decoded, with the id of this client's avatar, for checking what the server sends
+    using SnapshotCallback = std::function<void(const Snapshot&, std::uint32_t avatarID)>;
+    void setSnapshotCallback(SnapshotCallback callback) { m_snapshotCallback = callback; }
+
+    // Asks the server about each chunk as it loads
+    void handleMessage(const xy::Message&);
+
+    // Applies whatever the server has sent since the last call
+    void update(World&);
+
+    bool isConnected() const { return m_connection.isConnected(); }
+
+    std::size_t getSnapshotsReceived() const { return m_snapshotsReceived; }
+    std::size_t getSnapshotBytes() const { return m_snapshotBytes; }
+
+private:
+
+    NetConnection m_connection;
+    TerrainGenerator::Params m_params;
+    std::uint32_t m_clientID;
+
+    std::size_t m_verifiedChunks;
+    std::size_t m_mismatchedChunks;
+
+    NetDatagrams m_datagrams;
+    sf::IpAddress m_serverAddress;
+    unsigned short m_serverPort;
+    std::vector<std::uint8_t> m_datagram;
+
+    // Rebuilt snapshots by sequence, the server deltas against whichever was acknowledged last
+    std::array<Snapshot, SnapshotHistory> m_received;
+    bool m_hasSnapshot;
+    std::uint16_t m_newest;
+    bool m_newestApplied;
+    std::int32_t m_serverTick; // The newest sequence without wrapping, for interpolation timestamps
+
+    // From the newest snapshot, which entity is this client's avatar and the last of its inputs the server applied
+    std::uint32_t m_avatarID;
+    bool m_hasAppliedInput;
+    std::uint16_t m_appliedInput;
+
+    std::size_t m_snapshotsReceived;
+    std::size_t m_snapshotsMissingBaseline;
+    std::size_t m_snapshotBytes;
+
+    std::unordered_map<std::uint32_t, xy::Entity> m_entities;
+    SpawnCallback m_spawnCallback;
+    SnapshotCallback m_snapshotCallback;
+
+    void handlePacket(sf::Packet&, TerrainRenderer&);
+    void receiveSnapshots();
+    void applySnapshot(World&);
+    void sendAck(World&);
+    void sendInputs(World&);
+};
@@ -0,0 +1,129 @@
+#pragma once
+
+#include <SFML/Network/IpAddress.hpp>
+#include <SFML/Network/Packet.hpp>
+#include <SFML/Network/TcpListener.hpp>
+
+#include <xyginext/ecs/Entity.hpp>
+
+#include <array>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "NetConnection.hpp"
+#include "NetDatagrams.hpp"
+#include "InterestManager.hpp"
+#include "NetProtocol.hpp"
+#include "Prediction.hpp"
+#include "Snapshot.hpp"
+#include "TerrainChunk.hpp"
+#include "TerrainEdits.hpp"
+
+class World;
+class TerrainRenderer;
+
+// Serves a world to clients
+// Terrain goes over TCP: joining sends only the generator parameters, after that each chunk costs a hash plus its edits
+// Entities go over UDP: every step each client gets one datagram of what's changed since the last snapshot it acknowledged,
+// only for entities in the chunks around its focus, and less often the further they are from it
+// Each client controls an avatar by sending its inputs, one is applied per step and the newest applied is sent
+// back with each snapshot so the client can reconcile its prediction
+class WorldServer final
+{
+public:
+    explicit WorldServer(World&, const LinkConditions& = {});
+    ~WorldServer();
+
+    bool listen(unsigned short port);
+
+    // Accepts new clients, answers everything they've sent and sends each the latest snapshot, once per tick
+    void update();
+
+    // Edits the server's terrain and sends the edit to every client
+    void editTile(const TileEdit&);
+
+    std::size_t getClientCount() const { return m_clients.size(); }
+
+private:
+
+    struct Client
+    {
+        NetConnection connection;
+        std::uint32_t id = 0;
+
+        // Where its acknowledgements come from, snapshots start once the first one arrives
+        sf::IpAddress address;
+        unsigned short port = 0;
+
+        bool hasAck = false;
+        std::uint16_t acked = 0;
+        std::array<Snapshot, SnapshotHistory> sent; // What the client rebuilt from each, by sequence
+
+        // Moved by the client's inputs, queued in order and applied one per step
+        xy::Entity avatar;
+        std::deque<InputFrame> inputs;
+        bool hasQueued = false;
+        std::uint16_t lastQueued = 0;
+        bool hasApplied = false;
+        std::uint16_t lastApplied = 0;
+
+        // Changed entities which haven't been sent yet, by id, each is sent once it reaches 1
+        std::unordered_map<std::uint32_t, float> priority;
+
+        // For the bytes per entity per tick reported when it leaves
+        std::size_t snapshotCount = 0;
+        std::size_t snapshotBytes = 0;
+        std::size_t snapshotEntities = 0;
+        std::size_t snapshotsCut = 0;
+        std::size_t inputsApplied = 0;
+        std::size_t inputsDropped = 0;
+        std::size_t inputsStarved = 0;
+    };
+
+    World& m_world;
+    TerrainRenderer& m_terrain;
+
+    sf::TcpListener m_listener;
+    bool m_listening;
+
+    std::vector<std::unique_ptr<Client>> m_clients;
+    std::unique_ptr<Client> m_pending; // Filled by the next accept
+    std::uint32_t m_nextID;
+
+    NetDatagrams m_datagrams;
+    std::vector<std::uint8_t> m_datagram;
+
+    // An entity which is due to be sent, if there's room
+    struct Candidate
+    {
+        float priority = 0.f;
+        std::size_t index = 0; // Into the replicated snapshot
+        std::size_t slot = 0;  // Into m_relevant, or past its end if the client doesn't have it yet
+        std::size_t bits = 0;
+    };
+
+    InterestManager m_interest;
+    Snapshot m_relevant; // What's sent to the client being updated
+    std::vector<Candidate> m_candidates;
+
+    std::vector<sf::Vector2f> m_focuses; // Avatar positions terrain is streamed around
+
+    // For chunks the server doesn't have loaded, so requests for them don't regenerate every time
+    TerrainChunk m_scratch;
+    std::unordered_map<std::int64_t, std::uint64_t> m_chunkHashes;
+
+    void accept();
+    void handlePacket(Client&, sf::Packet&);
+    void receiveDatagrams();
+    void receiveAck(Client&, BitReader&);
+    void receiveInputs(Client&, BitReader&);
+    void applyInputs();
+    void sendSnapshot(Client&);
+    void prunePriorities(Client&, const Snapshot&, const std::vector<std::size_t>& relevant);
+    void logStats(const Client&) const;
+    std::uint64_t getChunkHash(sf::Vector2i);
+    const TerrainChunk& getEditedChunk(sf::Vector2i);
+};
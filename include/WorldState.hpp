@@ -6,14 +6,24 @@
 #include <xyginext/resources/Resource.hpp>
 #include <xyginext/graphics/SpriteSheet.hpp>
 
+#include <atomic>
+#include <memory>
+#include <thread>
+
+#include "FrameStats.hpp"
+#include "LoadingState.hpp"
+#include "RenderSnapshot.hpp"
+#include "SpscRing.hpp"
 #include "States.hpp"
-
-#include "FastNoise.h"
+#include "TripleBuffer.hpp"
+#include "World.hpp"
+#include "WorldClient.hpp"
 
 class WorldState final : public xy::State
 {
 public:
-    WorldState(xy::StateStack&, xy::State::Context);
+    WorldState(xy::StateStack&, xy::State::Context, Preload&);
+    ~WorldState();
 
     xy::StateID stateID() const override { return States::WorldPlayState; }
 
@@ -24,9 +34,30 @@ public:
 
 private:
 
-    xy::Scene m_scene;
+    // Declared first so they outlive the world's sprites
     xy::TextureResource m_textures;
-    xy::FontResource m_fonts;
 
-    xy::Entity m_player;
+    // The world's own bus when pipelined, as the app's is only safe to use from the main thread
+    xy::MessageBus m_worldBus;
+
+    // Only when joined to a server, it's created first because the world is built from the terrain it receives
+    std::unique_ptr<WorldClient> m_client;
+    World m_world;
+
+    // Pipelined, the world and the client are only touched by the simulation thread once it's started,
+    // the main thread just passes it input and draws whichever snapshot it published last
+    bool m_pipelined;
+    TripleBuffer<RenderSnapshot> m_snapshots;
+    SpscRing<float, 64> m_zoomRequests;
+    std::atomic<bool> m_stopping;
+    std::atomic<bool> m_finished;
+    FrameStats m_simulationStats;
+    std::thread m_simulationThread;
+
+    // Time to first interactive frame, reported when it's drawn
+    std::chrono::steady_clock::time_point m_launchTime;
+    bool m_drawnFirstFrame;
+
+    void runSimulation();
+    void reportFirstFrame();
 };
\ No newline at end of file
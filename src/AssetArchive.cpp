@@ -0,0 +1,161 @@
+#include "AssetArchive.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "Log.hpp"
+#include "Profiler.hpp"
+
+AssetArchive::~AssetArchive()
+{
+    close();
+}
+
+bool AssetArchive::open(const std::string& path)
+{
+    PROFILE_SCOPE("AssetArchive::open");
+
+    close();
+
+#ifdef _WIN32
+    m_file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (m_file == INVALID_HANDLE_VALUE)
+    {
+        m_file = nullptr;
+        return false;
+    }
+
+    LARGE_INTEGER size;
+    m_mapping = GetFileSizeEx(m_file, &size) && size.QuadPart > 0
+        ? CreateFileMappingA(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr) : nullptr;
+    if (!m_mapping)
+    {
+        close();
+        return false;
+    }
+
+    m_data = static_cast<const std::uint8_t*>(MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+    m_size = static_cast<std::size_t>(size.QuadPart);
+#else
+    // The mapping keeps the file alive, the descriptor isn't needed once it's made
+    int file = ::open(path.c_str(), O_RDONLY);
+    if (file < 0)
+        return false;
+
+    struct stat info;
+    void* data = MAP_FAILED;
+    if (fstat(file, &info) == 0 && info.st_size > 0)
+        data = mmap(nullptr, static_cast<std::size_t>(info.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+    ::close(file);
+
+    if (data == MAP_FAILED)
+        return false;
+
+    m_data = static_cast<const std::uint8_t*>(data);
+    m_size = static_cast<std::size_t>(info.st_size);
+#endif
+
+    if (!m_data || !validate())
+    {
+        LOG_WARNING("{} isn't an asset archive this build can read", path);
+        close();
+        return false;
+    }
+
+    LOG_INFO("Mapped {} packed assets from {}", m_entryCount, path);
+    return true;
+}
+
+void AssetArchive::close()
+{
+#ifdef _WIN32
+    if (m_data)
+        UnmapViewOfFile(m_data);
+    if (m_mapping)
+        CloseHandle(m_mapping);
+    if (m_file)
+        CloseHandle(m_file);
+    m_mapping = nullptr;
+    m_file = nullptr;
+#else
+    if (m_data)
+        munmap(const_cast<std::uint8_t*>(m_data), m_size);
+#endif
+
+    m_data = nullptr;
+    m_size = 0;
+    m_index = nullptr;
+    m_paths = nullptr;
+    m_entryCount = 0;
+}
+
+bool AssetArchive::find(const std::string& path, Entry& entry) const
+{
+    if (!m_data)
+        return false;
+
+    // Compared in place, the index is sorted by path
+    auto compare = [this, &path](const AssetPack::Entry& e)
+    {
+        return path.compare(0, path.size(), m_paths + e.pathOffset, e.pathLength);
+    };
+
+    auto end = m_index + m_entryCount;
+    auto found = std::lower_bound(m_index, end, path,
+        [&](const AssetPack::Entry& e, const std::string&) { return compare(e) > 0; });
+
+    if (found == end || compare(*found) != 0)
+        return false;
+
+    entry.data = m_data + found->offset;
+    entry.size = static_cast<std::size_t>(found->size);
+    entry.kind = static_cast<AssetPack::Kind>(found->kind);
+    entry.width = found->width;
+    entry.height = found->height;
+    return true;
+}
+
+//private
+bool AssetArchive::validate()
+{
+    // Everything the index points at is checked once here, so lookups don't have to
+    AssetPack::Header header;
+    if (m_size < sizeof(header))
+        return false;
+
+    std::memcpy(&header, m_data, sizeof(header));
+    if (header.magic != AssetPack::Magic || header.version != AssetPack::Version)
+        return false;
+
+    std::size_t pathsStart = sizeof(header) + std::size_t(header.entryCount) * sizeof(AssetPack::Entry);
+    if (pathsStart > m_size)
+        return false;
+
+    m_index = reinterpret_cast<const AssetPack::Entry*>(m_data + sizeof(header));
+    m_paths = reinterpret_cast<const char*>(m_data + pathsStart);
+    m_entryCount = header.entryCount;
+
+    for (std::uint32_t i(0); i < m_entryCount; i++)
+    {
+        const auto& e = m_index[i];
+        if (pathsStart + e.pathOffset + e.pathLength > m_size
+            || e.offset > m_size || e.size > m_size - e.offset
+            || (e.kind == AssetPack::Pixels && std::uint64_t(e.width) * e.height * 4 != e.size)
+            || e.kind > AssetPack::Pixels)
+        {
+            return false;
+        }
+    }
+    return true;
+}
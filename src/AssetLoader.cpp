@@ -0,0 +1,99 @@
+#include "AssetLoader.hpp"
+
+#include <chrono>
+
+#include "Log.hpp"
+#include "Profiler.hpp"
+
+namespace
+{
+    template<typename T>
+    bool isReady(const std::future<T>& result)
+    {
+        return result.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+    }
+
+    sf::Image decodeImage(const std::string& path)
+    {
+        PROFILE_SCOPE("AssetLoader::decodeImage");
+
+        sf::Image image;
+        if (!image.loadFromFile(path))
+            LOG_WARNING("Couldn't load image {}", path);
+        return image;
+    }
+
+    sf::Image decodePackedImage(const std::string& path, AssetArchive::Entry packed)
+    {
+        PROFILE_SCOPE("AssetLoader::decodeImage");
+
+        sf::Image image;
+        if (!image.loadFromMemory(packed.data, packed.size))
+            LOG_WARNING("Couldn't load packed image {}", path);
+        return image;
+    }
+}
+
+bool AssetLoader::openArchive(const std::string& path)
+{
+    return m_archive.open(path);
+}
+
+void AssetLoader::queueImage(const std::string& path)
+{
+    if (m_textures.count(path))
+        return;
+
+    auto& texture = m_textures[path];
+    if (!m_archive.find(path, texture.packed))
+        texture.image = std::async(std::launch::async, decodeImage, path);
+    else if (texture.packed.kind != AssetPack::Pixels)
+        texture.image = std::async(std::launch::async, decodePackedImage, path, texture.packed);
+}
+
+bool AssetLoader::update()
+{
+    PROFILE_SCOPE("AssetLoader::update");
+
+    for (auto& entry : m_textures)
+    {
+        auto& texture = entry.second;
+        if (texture.loaded)
+            continue;
+
+        // The upload is all that's left for this thread, pre-decoded pixels go straight from the mapping
+        if (texture.packed.kind == AssetPack::Pixels)
+        {
+            if (texture.texture.create(texture.packed.width, texture.packed.height))
+                texture.texture.update(texture.packed.data);
+            else
+                LOG_WARNING("Couldn't create a texture for {}", entry.first);
+        }
+        else
+        {
+            if (!isReady(texture.image))
+                continue;
+
+            auto image = texture.image.get();
+            if (image.getSize().x > 0 && !texture.texture.loadFromImage(image))
+                LOG_WARNING("Couldn't create a texture for {}", entry.first);
+        }
+
+        texture.loaded = true;
+        m_loadedCount++;
+    }
+
+    return m_loadedCount == m_textures.size();
+}
+
+float AssetLoader::getProgress() const
+{
+    return m_textures.empty() ? 1.f : static_cast<float>(m_loadedCount) / m_textures.size();
+}
+
+const sf::Texture& AssetLoader::getTexture(const std::string& path) const
+{
+    static const sf::Texture Missing;
+    auto texture = m_textures.find(path);
+    return texture != m_textures.end() ? texture->second.texture : Missing;
+}
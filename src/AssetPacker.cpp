@@ -0,0 +1,156 @@
+#include <SFML/Graphics/Image.hpp>
+
+#include <algorithm>
+#include <cctype>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "AssetArchive.hpp"
+#include "Log.hpp"
+
+// Build step which packs assets into the archive AssetLoader maps at startup
+// Usage: xyworld-pack [--keep-png] <archive> <root> <path>...
+// Each path is read from under root and packed under the path itself, the one the game loads it by.
+// PNGs are stored decoded, so the game only has to upload them. With the page cache dropped, getting the
+// 968x526 terrain sheet's pixels out of the mapping took 3.6-5.5ms raw (2MB) against 11-15ms decoding its
+// 98KB PNG, with the same syscalls and page faults, as the archive is mapped the same way either way.
+// --keep-png stores them as they are instead, decoded on a worker at startup, to compare on other hardware.
+
+namespace
+{
+    struct Packed
+    {
+        std::string path;
+        std::vector<std::uint8_t> data;
+        AssetPack::Kind kind = AssetPack::File;
+        unsigned width = 0;
+        unsigned height = 0;
+    };
+
+    bool endsWith(const std::string& str, const std::string& suffix)
+    {
+        return str.size() >= suffix.size() && std::equal(suffix.rbegin(), suffix.rend(), str.rbegin(),
+            [](char a, char b) { return std::tolower(a) == std::tolower(b); });
+    }
+
+    bool readAsset(const std::string& root, Packed& asset, bool decodeImages)
+    {
+        auto file = root + "/" + asset.path;
+        if (decodeImages && endsWith(asset.path, ".png"))
+        {
+            sf::Image image;
+            if (!image.loadFromFile(file))
+                return false;
+
+            asset.kind = AssetPack::Pixels;
+            asset.width = image.getSize().x;
+            asset.height = image.getSize().y;
+            const auto* pixels = image.getPixelsPtr();
+            asset.data.assign(pixels, pixels + std::size_t(asset.width) * asset.height * 4);
+            return true;
+        }
+
+        std::ifstream in(file, std::ios::binary);
+        if (!in)
+            return false;
+
+        asset.data.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+        return true;
+    }
+
+    std::uint64_t align(std::uint64_t offset)
+    {
+        return (offset + AssetPack::Alignment - 1) / AssetPack::Alignment * AssetPack::Alignment;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    Log::start();
+
+    int first = 1;
+    bool decodeImages = true;
+    if (argc > 1 && std::string(argv[1]) == "--keep-png")
+    {
+        decodeImages = false;
+        first++;
+    }
+
+    if (argc < first + 2)
+    {
+        LOG_ERROR("Usage: {} [--keep-png] <archive> <root> <path>...", argv[0]);
+        Log::stop();
+        return 1;
+    }
+
+    std::string output(argv[first]);
+    std::string root(argv[first + 1]);
+
+    std::vector<Packed> assets(argc - first - 2);
+    for (std::size_t i(0); i < assets.size(); i++)
+    {
+        auto& asset = assets[i];
+        asset.path = argv[i + first + 2];
+        if (!readAsset(root, asset, decodeImages))
+        {
+            LOG_ERROR("Couldn't read {}/{}", root, asset.path);
+            Log::stop();
+            return 1;
+        }
+    }
+
+    // Sorted so the game can binary search the index in place
+    std::sort(assets.begin(), assets.end(), [](const Packed& a, const Packed& b) { return a.path < b.path; });
+    assets.erase(std::unique(assets.begin(), assets.end(), [](const Packed& a, const Packed& b) { return a.path == b.path; }), assets.end());
+
+    AssetPack::Header header{};
+    header.magic = AssetPack::Magic;
+    header.version = AssetPack::Version;
+    header.entryCount = static_cast<std::uint32_t>(assets.size());
+
+    std::string paths;
+    std::vector<AssetPack::Entry> index(assets.size());
+    for (std::size_t i(0); i < assets.size(); i++)
+    {
+        index[i].pathOffset = static_cast<std::uint32_t>(paths.size());
+        index[i].pathLength = static_cast<std::uint32_t>(assets[i].path.size());
+        paths += assets[i].path;
+    }
+
+    std::uint64_t offset = align(sizeof(header) + index.size() * sizeof(AssetPack::Entry) + paths.size());
+    for (std::size_t i(0); i < assets.size(); i++)
+    {
+        auto& entry = index[i];
+        entry.offset = offset;
+        entry.size = assets[i].data.size();
+        entry.kind = assets[i].kind;
+        entry.width = assets[i].width;
+        entry.height = assets[i].height;
+        offset = align(offset + entry.size);
+    }
+
+    std::ofstream out(output, std::ios::binary | std::ios::trunc);
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char*>(index.data()), index.size() * sizeof(AssetPack::Entry));
+    out.write(paths.data(), paths.size());
+
+    for (std::size_t i(0); i < assets.size(); i++)
+    {
+        auto position = static_cast<std::uint64_t>(out.tellp());
+        std::fill_n(std::ostreambuf_iterator<char>(out), index[i].offset - position, '\0');
+        out.write(reinterpret_cast<const char*>(assets[i].data.data()), assets[i].data.size());
+    }
+
+    if (!out)
+    {
+        LOG_ERROR("Couldn't write {}", output);
+        Log::stop();
+        return 1;
+    }
+
+    LOG_INFO("Packed {} assets into {}, {} bytes", assets.size(), output, static_cast<std::uint64_t>(out.tellp()));
+    Log::stop();
+    return 0;
+}
@@ -0,0 +1,112 @@
+#include "BitStream.hpp"
+
+#include <algorithm>
+#include <array>
+
+namespace
+{
+    // Bits used by each of writeVar's width classes
+    const std::array<int, 4> VarWidths = { { 4, 8, 16, 32 } };
+}
+
+BitWriter::BitWriter(std::vector<std::uint8_t>& buffer) :
+    m_buffer(buffer),
+    m_bitCount(0)
+{
+    m_buffer.clear();
+}
+
+void BitWriter::write(std::uint32_t value, int bits)
+{
+    m_buffer.resize((m_bitCount + bits + 7) / 8, 0);
+
+    // A byte at a time, filling whatever's left of the current byte first
+    std::uint64_t remaining = bits < 32 ? value & ((std::uint32_t(1) << bits) - 1) : value;
+    while (bits > 0)
+    {
+        int offset = static_cast<int>(m_bitCount & 7);
+        int count = std::min(8 - offset, bits);
+
+        m_buffer[m_bitCount >> 3] |= static_cast<std::uint8_t>((remaining & ((1u << count) - 1)) << offset);
+
+        remaining >>= count;
+        bits -= count;
+        m_bitCount += count;
+    }
+}
+
+void BitWriter::writeVar(std::uint32_t value)
+{
+    // The last class is a full 32 bits so it takes anything
+    std::uint32_t widthClass = 0;
+    while (widthClass < VarWidths.size() - 1 && value >= (std::uint32_t(1) << VarWidths[widthClass]))
+    {
+        widthClass++;
+    }
+
+    write(widthClass, 2);
+    write(value, VarWidths[widthClass]);
+}
+
+void BitWriter::writeSigned(std::int32_t value)
+{
+    writeVar((static_cast<std::uint32_t>(value) << 1) ^ static_cast<std::uint32_t>(value >> 31));
+}
+
+void BitWriter::rewind(std::size_t bitCount)
+{
+    if (bitCount >= m_bitCount)
+        return;
+
+    m_bitCount = bitCount;
+    m_buffer.resize(getByteCount());
+
+    // Clear the discarded bits of the last byte, writes OR into it
+    if (m_bitCount & 7)
+        m_buffer.back() &= static_cast<std::uint8_t>((1u << (m_bitCount & 7)) - 1);
+}
+
+
+BitReader::BitReader(const std::uint8_t* data, std::size_t size) :
+    m_data(data),
+    m_bitSize(size * 8),
+    m_bitCount(0),
+    m_valid(true)
+{
+
+}
+
+std::uint32_t BitReader::read(int bits)
+{
+    if (!m_valid || m_bitCount + bits > m_bitSize)
+    {
+        m_valid = false;
+        return 0;
+    }
+
+    std::uint64_t value = 0;
+    int shift = 0;
+    while (bits > 0)
+    {
+        int offset = static_cast<int>(m_bitCount & 7);
+        int count = std::min(8 - offset, bits);
+
+        value |= static_cast<std::uint64_t>((m_data[m_bitCount >> 3] >> offset) & ((1u << count) - 1)) << shift;
+
+        shift += count;
+        bits -= count;
+        m_bitCount += count;
+    }
+    return static_cast<std::uint32_t>(value);
+}
+
+std::uint32_t BitReader::readVar()
+{
+    return read(VarWidths[read(2)]);
+}
+
+std::int32_t BitReader::readSigned()
+{
+    auto value = readVar();
+    return static_cast<std::int32_t>((value >> 1) ^ (~(value & 1) + 1));
+}
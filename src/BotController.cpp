@@ -0,0 +1,68 @@
+#include "BotController.hpp"
+
+#include <xyginext/ecs/components/Transform.hpp>
+
+#include <cmath>
+
+#include "InputState.hpp"
+#include "Profiler.hpp"
+
+namespace
+{
+    // Bots head back once they're this far from home
+    const float WanderRadius(256.f);
+
+    // Seconds between changes of direction
+    const float MinWanderTime(1.f);
+    const float MaxWanderTime(4.f);
+
+    // Chance of standing still rather than walking
+    const float IdleChance(0.25f);
+}
+
+BotController::BotController(xy::MessageBus& mb, int seed) :
+    xy::System(mb, typeid(BotController)),
+    m_random(static_cast<std::mt19937::result_type>(seed))
+{
+    requireComponent<Bot>();
+    requireComponent<InputState>();
+    requireComponent<xy::Transform>();
+}
+
+void BotController::process(float dt)
+{
+    PROFILE_SCOPE("BotController::process");
+
+    std::uniform_real_distribution<float> chance(0.f, 1.f);
+    std::uniform_real_distribution<float> angle(0.f, 6.2831853f);
+    std::uniform_real_distribution<float> wanderTime(MinWanderTime, MaxWanderTime);
+
+    for (auto& ent : getEntities())
+    {
+        auto& bot = ent.getComponent<Bot>();
+        bot.timer -= dt;
+        if (bot.timer <= 0.f)
+        {
+            bot.timer = wanderTime(m_random);
+
+            auto offset = bot.home - ent.getComponent<xy::Transform>().getPosition();
+            float distance = std::hypot(offset.x, offset.y);
+            if (distance > WanderRadius)
+            {
+                bot.direction = offset / distance;
+            }
+            else if (chance(m_random) < IdleChance)
+            {
+                bot.direction = {};
+            }
+            else
+            {
+                float a = angle(m_random);
+                bot.direction = { std::cos(a), std::sin(a) };
+            }
+        }
+
+        // InputDirector zeroes a player's input every step, this keeps a bot steering one
+        ent.getComponent<InputState>().movement = bot.direction;
+    }
+}
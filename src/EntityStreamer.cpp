@@ -0,0 +1,313 @@
+#include "EntityStreamer.hpp"
+
+#include <xyginext/ecs/Scene.hpp>
+#include <xyginext/ecs/components/Transform.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+#include "Collider.hpp"
+#include "Log.hpp"
+#include "Messages.hpp"
+#include "Profiler.hpp"
+#include "SpatialGrid.hpp"
+#include "TerrainChunk.hpp"
+#include "Velocity.hpp"
+
+namespace
+{
+    // How often live entities are checked for having wandered into a chunk which isn't loaded
+    const float ResidencyInterval(1.f);
+
+    // Longest absence caught up on restore, so an old save doesn't fling everything to its chunk's edge
+    const double MaxCatchUpTime(60.0);
+
+    const char Magic[4] = { 'X', 'Y', 'W', 'S' };
+    const std::uint32_t Version(1);
+
+    enum EntityFlags : std::uint8_t
+    {
+        HasVelocity = 0x1
+    };
+
+    template<typename T>
+    void put(std::vector<std::uint8_t>& data, const T& value)
+    {
+        auto offset = data.size();
+        data.resize(offset + sizeof(T));
+        std::memcpy(&data[offset], &value, sizeof(T));
+    }
+
+    template<typename T>
+    bool get(const std::vector<std::uint8_t>& data, std::size_t& offset, T& value)
+    {
+        if (offset + sizeof(T) > data.size())
+            return false;
+
+        std::memcpy(&value, &data[offset], sizeof(T));
+        offset += sizeof(T);
+        return true;
+    }
+
+    template<typename T>
+    void writeValue(std::ofstream& file, const T& value)
+    {
+        file.write(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    template<typename T>
+    bool readValue(std::ifstream& file, T& value)
+    {
+        return static_cast<bool>(file.read(reinterpret_cast<char*>(&value), sizeof(T)));
+    }
+}
+
+EntityStreamer::EntityStreamer(xy::MessageBus& mb, int seed, const std::string& savePath) :
+    xy::System(mb, typeid(EntityStreamer)),
+    m_seed(seed),
+    m_savePath(savePath),
+    m_time(0.0),
+    m_residencyTimer(0.f),
+    m_catchUp(true)
+{
+    requireComponent<Streamed>();
+    requireComponent<Collider>();
+    requireComponent<xy::Transform>();
+
+    load();
+}
+
+void EntityStreamer::handleMessage(const xy::Message& msg)
+{
+    if (msg.id == ChunkMessage)
+    {
+        const auto& data = msg.getData<ChunkEvent>();
+        if (data.type == ChunkEvent::Loaded)
+        {
+            m_loadedChunks.insert(chunkKey(data.index));
+            restore(data.index);
+        }
+        else
+        {
+            m_loadedChunks.erase(chunkKey(data.index));
+
+            // The grid already has every collider filed by chunk, so this only visits the evicted one's
+            m_chunkEntities.clear();
+            getScene()->getSystem<SpatialGrid>().getChunkEntities(data.index, m_chunkEntities);
+            for (auto ent : m_chunkEntities)
+            {
+                if (ent.hasComponent<Streamed>())
+                    suspend(ent, data.index);
+            }
+        }
+    }
+}
+
+void EntityStreamer::process(float dt)
+{
+    PROFILE_SCOPE("EntityStreamer::process");
+
+    m_time += dt;
+
+    m_residencyTimer += dt;
+    if (m_residencyTimer < ResidencyInterval)
+        return;
+    m_residencyTimer = 0.f;
+
+    for (auto& ent : getEntities())
+    {
+        auto chunk = SpatialGrid::getChunk(ent);
+        if (m_loadedChunks.count(chunkKey(chunk)) == 0)
+            suspend(ent, chunk);
+    }
+}
+
+void EntityStreamer::registerArchetype(std::uint16_t archetype, Builder builder)
+{
+    m_builders[archetype] = std::move(builder);
+}
+
+void EntityStreamer::save()
+{
+    if (m_savePath.empty())
+        return;
+
+    for (auto& ent : getEntities())
+    {
+        suspend(ent, SpatialGrid::getChunk(ent));
+    }
+
+    std::ofstream file(m_savePath, std::ios::binary);
+    if (!file)
+    {
+        LOG_ERROR("Failed to open {} for saving", m_savePath);
+        return;
+    }
+
+    file.write(Magic, sizeof(Magic));
+    writeValue(file, Version);
+    writeValue(file, static_cast<std::int32_t>(m_seed));
+    writeValue(file, m_time);
+    writeValue(file, static_cast<std::uint32_t>(m_blobs.size()));
+
+    for (const auto& blob : m_blobs)
+    {
+        writeValue(file, blob.first);
+        writeValue(file, blob.second.suspendedAt);
+        writeValue(file, blob.second.count);
+        writeValue(file, static_cast<std::uint32_t>(blob.second.data.size()));
+        file.write(reinterpret_cast<const char*>(blob.second.data.data()), blob.second.data.size());
+    }
+
+    LOG_INFO("Saved {} chunks of entities to {}", m_blobs.size(), m_savePath);
+}
+
+std::size_t EntityStreamer::getSuspendedCount() const
+{
+    std::size_t count = 0;
+    for (const auto& blob : m_blobs)
+    {
+        count += blob.second.count;
+    }
+    return count;
+}
+
+//private
+void EntityStreamer::suspend(xy::Entity ent, sf::Vector2i chunk)
+{
+    // Destroying is deferred, so it may be seen again before it's gone
+    if (!m_suspended.insert(ent.getIndex()).second)
+        return;
+
+    auto& blob = m_blobs[chunkKey(chunk)];
+    if (blob.count == 0)
+        blob.suspendedAt = m_time;
+
+    auto position = ent.getComponent<xy::Transform>().getPosition();
+    std::uint8_t flags = ent.hasComponent<Velocity>() ? HasVelocity : 0;
+
+    put(blob.data, ent.getComponent<Streamed>().archetype);
+    put(blob.data, flags);
+    put(blob.data, position.x);
+    put(blob.data, position.y);
+    if (flags & HasVelocity)
+    {
+        const auto& velocity = ent.getComponent<Velocity>();
+        put(blob.data, velocity.x);
+        put(blob.data, velocity.y);
+    }
+    blob.count++;
+
+    getScene()->destroyEntity(ent);
+}
+
+void EntityStreamer::restore(sf::Vector2i chunk)
+{
+    auto result = m_blobs.find(chunkKey(chunk));
+    if (result == m_blobs.end())
+        return;
+
+    const auto& blob = result->second;
+    float elapsed = m_catchUp ? static_cast<float>(std::min(m_time - blob.suspendedAt, MaxCatchUpTime)) : 0.f;
+
+    // Keep caught up entities inside the chunk they were suspended with, going by where the grid files them
+    sf::Vector2f chunkMin(chunk.x * ChunkSize * TileSize, chunk.y * ChunkSize * TileSize);
+    sf::Vector2f chunkMax(chunkMin.x + ChunkSize * TileSize - 1.f, chunkMin.y + ChunkSize * TileSize - 1.f);
+
+    std::size_t offset = 0;
+    for (std::uint32_t i(0); i < blob.count; i++)
+    {
+        std::uint16_t archetype;
+        std::uint8_t flags;
+        sf::Vector2f position, velocity;
+        if (!get(blob.data, offset, archetype) || !get(blob.data, offset, flags)
+            || !get(blob.data, offset, position.x) || !get(blob.data, offset, position.y)
+            || ((flags & HasVelocity) && !(get(blob.data, offset, velocity.x) && get(blob.data, offset, velocity.y))))
+        {
+            LOG_ERROR("Entities saved in chunk {},{} are corrupt", chunk.x, chunk.y);
+            break;
+        }
+
+        auto builder = m_builders.find(archetype);
+        if (builder == m_builders.end())
+        {
+            LOG_WARNING("No builder for archetype {}, entity dropped", archetype);
+            continue;
+        }
+
+        auto moved = velocity * elapsed;
+        position += moved;
+
+        auto ent = getScene()->createEntity();
+        ent.addComponent<xy::Transform>().setPosition(position);
+        ent.addComponent<Streamed>().archetype = archetype;
+        if (flags & HasVelocity)
+            ent.addComponent<Velocity>() = velocity;
+
+        builder->second(ent);
+
+        // Anything which wasn't moved is already where it was filed, so it's left exactly as it was saved
+        if ((moved.x != 0.f || moved.y != 0.f) && ent.hasComponent<Collider>())
+        {
+            const auto& bounds = ent.getComponent<Collider>().bounds;
+            sf::Vector2f centre(position.x + bounds.left + bounds.width / 2.f, position.y + bounds.top + bounds.height / 2.f);
+            sf::Vector2f clamped(std::min(std::max(centre.x, chunkMin.x), chunkMax.x), std::min(std::max(centre.y, chunkMin.y), chunkMax.y));
+            ent.getComponent<xy::Transform>().move(clamped - centre);
+        }
+    }
+
+    m_blobs.erase(result);
+}
+
+void EntityStreamer::onEntityRemoved(xy::Entity ent)
+{
+    m_suspended.erase(ent.getIndex());
+}
+
+void EntityStreamer::load()
+{
+    if (m_savePath.empty())
+        return;
+
+    std::ifstream file(m_savePath, std::ios::binary);
+    if (!file)
+        return;
+
+    char magic[4];
+    std::uint32_t version;
+    std::int32_t seed;
+    std::uint32_t blobCount;
+    if (!file.read(magic, sizeof(magic)) || std::memcmp(magic, Magic, sizeof(Magic)) != 0
+        || !readValue(file, version) || version != Version
+        || !readValue(file, seed) || !readValue(file, m_time) || !readValue(file, blobCount))
+    {
+        LOG_ERROR("{} is not a valid save", m_savePath);
+        m_time = 0.0;
+        return;
+    }
+
+    if (seed != m_seed)
+    {
+        LOG_WARNING("{} belongs to world {}, not loading it", m_savePath, seed);
+        m_time = 0.0;
+        return;
+    }
+
+    for (std::uint32_t i(0); i < blobCount; i++)
+    {
+        std::int64_t key;
+        ChunkBlob blob;
+        std::uint32_t size;
+        if (!readValue(file, key) || !readValue(file, blob.suspendedAt) || !readValue(file, blob.count) || !readValue(file, size))
+            break;
+
+        blob.data.resize(size);
+        if (!file.read(reinterpret_cast<char*>(blob.data.data()), size))
+            break;
+
+        m_blobs[key] = std::move(blob);
+    }
+
+    LOG_INFO("Loaded {} chunks of entities from {}", m_blobs.size(), m_savePath);
+}
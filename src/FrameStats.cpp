@@ -0,0 +1,25 @@
+#include "FrameStats.hpp"
+#include "Log.hpp"
+
+#include <algorithm>
+#include <numeric>
+
+void FrameStats::logSummary(const char* name) const
+{
+    if (m_frames.empty())
+        return;
+
+    auto sorted = m_frames;
+    std::sort(sorted.begin(), sorted.end());
+
+    auto percentile = [&](float p)
+    {
+        auto index = static_cast<std::size_t>(p * (sorted.size() - 1) + 0.5f);
+        return sorted[index] * 1000.f;
+    };
+
+    float mean = std::accumulate(sorted.begin(), sorted.end(), 0.f) / sorted.size() * 1000.f;
+
+    LOG_INFO("{} {}, mean {}ms, max {}ms", sorted.size(), name, mean, sorted.back() * 1000.f);
+    LOG_INFO("p50 {}ms, p95 {}ms, p99 {}ms", percentile(0.5f), percentile(0.95f), percentile(0.99f));
+}
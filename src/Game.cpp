@@ -30,8 +30,19 @@ source distribution.
 #include <SFML/Window/Event.hpp>
 #include <SFML/Audio.hpp>
 
+#include "LoadingState.hpp"
 #include "States.hpp"
 #include "WorldState.hpp"
+#include "Profiler.hpp"
+
+#ifdef ENABLE_PROFILER
+namespace
+{
+    // Writes the trace so far, it's also written on exit
+    const sf::Keyboard::Key ProfileDumpKey(sf::Keyboard::F9);
+    const std::string ProfileFile("profile.json");
+}
+#endif
 
 Game::Game()
     : xy::App   (/*sf::ContextSettings(0, 0, 0, 3, 2, sf::ContextSettings::Core)*/),
@@ -43,6 +54,12 @@ Game::Game()
 //private
 void Game::handleEvent(const sf::Event& evt)
 {    
+#ifdef ENABLE_PROFILER
+    if (evt.type == sf::Event::KeyReleased && evt.key.code == ProfileDumpKey)
+    {
+        Profiler::writeTrace(ProfileFile);
+    }
+#endif
     m_stateStack.handleEvent(evt);
 }
 
@@ -53,27 +70,40 @@ void Game::handleMessage(const xy::Message& msg)
 
 void Game::updateApp(float dt)
 {
+    PROFILE_SCOPE("Game::update");
+
+    m_frameStats.addFrame(dt);
+
     m_stateStack.update(dt);
 }
 
 void Game::draw()
 {
+    PROFILE_SCOPE("Game::draw");
     m_stateStack.draw();
 }
 
 void Game::initialise()
 {
+    PROFILE_THREAD_NAME("Main");
     registerStates();
-    m_stateStack.pushState(States::WorldPlayState);
+    m_stateStack.pushState(States::WorldLoadState);
 }
 
 void Game::finalise()
 {
     m_stateStack.clearStates();
     m_stateStack.applyPendingChanges();
+
+    m_frameStats.logSummary();
+
+#ifdef ENABLE_PROFILER
+    Profiler::writeTrace(ProfileFile);
+#endif
 }
 
 void Game::registerStates()
 {
-    m_stateStack.registerState<WorldState>(States::WorldPlayState);
+    m_stateStack.registerState<LoadingState>(States::WorldLoadState, m_preload);
+    m_stateStack.registerState<WorldState>(States::WorldPlayState, m_preload);
 }
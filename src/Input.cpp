@@ -1,115 +1,216 @@
 #include "Input.hpp"
 #include <xyginext/ecs/Scene.hpp>
 #include <SFML/Window/Event.hpp>
-#include <xyginext/ecs/components/Transform.hpp>
-#include <xyginext/ecs/components/Sprite.hpp>
-#include <xyginext/ecs/components/SpriteAnimation.hpp>
 
-#include "Commands.hpp"
+#include <algorithm>
+#include <cmath>
+
+#include "InputState.hpp"
+#include "Log.hpp"
+#include "PlayerController.hpp"
+#include "Profiler.hpp"
 #include <xyginext/util/Vector.hpp>
 
+namespace
+{
+    // basic crappy dead zone
+    const float DZ(0.2f);
+}
+
+InputDirector::InputDirector() :
+    m_lastProcess(InputEvent::Clock::now()),
+    m_hasApplied(false),
+    m_playbackFinished(false)
+{
+
+}
+
 void InputDirector::handleEvent(const sf::Event& ev)
 {
-    // The input struct, to be sent out in a command to interested Entities
-    if (ev.type == sf::Event::KeyPressed)
-    {
-        m_pressedKeys.insert(ev.key.code);
-    }
-    else if (ev.type == sf::Event::KeyReleased)
+    // Stamp and queue raw events, they're applied in order in process()
+    InputEvent evt;
+    evt.time = InputEvent::Clock::now();
+
+    if (ev.type == sf::Event::KeyPressed || ev.type == sf::Event::KeyReleased)
     {
-        m_pressedKeys.erase(ev.key.code);
+        if (ev.key.code < 0 || ev.key.code >= sf::Keyboard::KeyCount)
+            return;
+
+        evt.type = ev.type == sf::Event::KeyPressed ? InputEvent::KeyPressed : InputEvent::KeyReleased;
+        evt.key = ev.key.code;
     }
     else if (ev.type == sf::Event::JoystickMoved)
     {
         // For joysticks, get the id first
-        auto& i = m_playerInput[ev.joystickMove.joystickId];
+        if (ev.joystickMove.joystickId >= m_playerInput.size())
+            return;
+
+        evt.type = InputEvent::JoystickMoved;
+        evt.joystick = ev.joystickMove.joystickId;
+        evt.axis = ev.joystickMove.axis;
+        evt.position = ev.joystickMove.position / 100.f;
+    }
+    else
+    {
+        return;
+    }
+
+    if (!m_events.push(evt))
+    {
+        LOG_WARNING("Input queue full, event dropped");
+    }
+}
 
-        switch (ev.joystickMove.axis)
+void InputDirector::process(float dt)
+{
+    PROFILE_SCOPE("InputDirector::process");
+
+    // Integrate each player's movement since the last step, switching state at each event's timestamp
+    // rather than applying everything at the step boundary
+    auto now = InputEvent::Clock::now();
+    auto segmentStart = m_lastProcess;
+    std::array<sf::Vector2f, PlayerCount> integrated = {};
+
+    auto integrate = [&](InputEvent::Clock::time_point segmentEnd)
+    {
+        float seconds = std::chrono::duration<float>(segmentEnd - segmentStart).count();
+        for (int i(0); i < PlayerCount; i++)
+        {
+            integrated[i] += getMovement(static_cast<Player>(i)) * seconds;
+        }
+        segmentStart = segmentEnd;
+    };
+
+    InputEvent evt;
+    while (m_events.pop(evt))
+    {
+        integrate(std::min(std::max(evt.time, segmentStart), now));
+        apply(evt);
+
+        if (!m_hasApplied || evt.time < m_oldestApplied)
+        {
+            m_oldestApplied = evt.time;
+            m_hasApplied = true;
+        }
+    }
+    integrate(now);
+
+    float frameTime = std::chrono::duration<float>(now - m_lastProcess).count();
+    m_lastProcess = now;
+
+    RecordedFrame frame;
+    if (m_playback.isOpen())
+    {
+        // Live input is still drained above so the queue never fills, but the recording wins
+        if (!m_playback.read(frame))
+        {
+            if (!m_playbackFinished)
+                LOG_INFO("Playback finished");
+
+            m_playbackFinished = true;
+            return;
+        }
+        m_keys = frame.keys;
+    }
+    else
+    {
+        for (int i(0); i < PlayerCount; i++)
+        {
+            frame.movement[i] = frameTime > 0.f ? integrated[i] / frameTime : getMovement(static_cast<Player>(i));
+        }
+        frame.keys = m_keys;
+        m_recorder.write(frame);
+    }
+
+    // Write each player's average input since the last step straight into the entity it controls
+    const auto& controller = getScene().getSystem<PlayerController>();
+    for (int i(0); i < PlayerCount; i++)
+    {
+        auto ent = controller.getPlayer(static_cast<Player>(i));
+        if (ent != xy::Entity())
+        {
+            ent.getComponent<InputState>().movement = frame.movement[i];
+        }
+    }
+}
+
+bool InputDirector::takeOldestApplied(InputEvent::Clock::time_point& time)
+{
+    if (!m_hasApplied)
+        return false;
+
+    time = m_oldestApplied;
+    m_hasApplied = false;
+    return true;
+}
+
+bool InputDirector::startRecording(const std::string& path, int seed, float timestep)
+{
+    return m_recorder.open(path, seed, timestep);
+}
+
+bool InputDirector::startPlayback(const std::string& path)
+{
+    return m_playback.open(path);
+}
+
+//private
+void InputDirector::apply(const InputEvent& evt)
+{
+    switch (evt.type)
+    {
+    case InputEvent::KeyPressed:
+        m_keys.set(evt.key);
+        break;
+
+    case InputEvent::KeyReleased:
+        m_keys.reset(evt.key);
+        break;
+
+    case InputEvent::JoystickMoved:
+    {
+        auto& i = m_playerInput[evt.joystick];
+
+        switch (evt.axis)
         {
         case sf::Joystick::Axis::X:
-            i.xy.x = ev.joystickMove.position/100.f;
+            i.xy.x = evt.position;
             break;
 
         case sf::Joystick::Axis::Y:
-            i.xy.y = ev.joystickMove.position/100.f;
+            i.xy.y = evt.position;
+            break;
+
+        default:
+            break;
         }
+        break;
+    }
     }
 }
 
-void InputDirector::process(float dt)
+sf::Vector2f InputDirector::getMovement(Player player) const
 {
-    // Handle input with commands
-    int player = PlayerOne;
-    for (auto& i : m_playerInput)
+    // The keyboard drives player one and overrides its joystick while any direction is held
+    if (player == PlayerOne)
     {
-        xy::Command cmd;
-        cmd.targetFlags |= player;
-        player <<= 1;
-        cmd.action = [&i](xy::Entity e, float dt)
-        {
-            auto& t = e.getComponent<xy::Transform>();
-           
-            // basic crappy dead zone
-            const float DZ(0.2f);
-            if (std::fabs(xy::Util::Vector::length(i.xy)) < DZ)
-                i.xy = { 0,0 };
-
-            xy::Logger::log("movement = " + std::to_string(i.xy.x) + " " + std::to_string(i.xy.y));
-            //execute move
-            t.move(i.xy);
-
-            // Probably shouldn't be doing this here
-            // Update animation based on movement
-            auto& a = e.getComponent<xy::SpriteAnimation>();
-
-            static int currentAnim;
-            int animId(-1);
-
-            //hacky...
-            float dx(i.xy.x), dy(i.xy.y);
-            if (std::fabs(i.xy.x) > std::fabs(i.xy.y))
-                dy = 0.f;
-            else
-                dx = 0.f;
-
-            // Down
-            if (dy > 0.f)
-                animId = 0;
-            
-            // Left
-            if (dx < 0.f)
-                animId = 1;
-
-            // Up
-            if (dy < 0.f)
-                animId = 2;
-
-            // Right
-            if (dx > 0.f)
-                animId = 3;
-
-            if (animId > -1)
-            {
-                if (animId != currentAnim)
-                {
-                    a.stop();
-                    currentAnim = animId;
-                    a.play(animId);
-                }
-                a.play(animId);
-            }
-            else
-            {
-                a.pause();
-            }
-            
-            // Force it to int position to prevent artifacts
-            auto pos = t.getPosition();
-            pos.x = std::round(pos.x);
-            pos.y = std::round(pos.y);
-            t.setPosition(pos);
-        };
-
-        getScene().getSystem<xy::CommandSystem>().sendCommand(cmd);
+        sf::Vector2f keys;
+        if (m_keys[sf::Keyboard::W] || m_keys[sf::Keyboard::Up])
+            keys.y -= 1.f;
+        if (m_keys[sf::Keyboard::S] || m_keys[sf::Keyboard::Down])
+            keys.y += 1.f;
+        if (m_keys[sf::Keyboard::A] || m_keys[sf::Keyboard::Left])
+            keys.x -= 1.f;
+        if (m_keys[sf::Keyboard::D] || m_keys[sf::Keyboard::Right])
+            keys.x += 1.f;
+
+        if (keys.x != 0.f || keys.y != 0.f)
+            return xy::Util::Vector::normalise(keys);
     }
-}
\ No newline at end of file
+
+    const auto& stick = m_playerInput[player].xy;
+    if (std::fabs(xy::Util::Vector::length(stick)) < DZ)
+        return {};
+
+    return stick;
+}
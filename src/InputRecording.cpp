@@ -0,0 +1,134 @@
+#include "InputRecording.hpp"
+#include "Log.hpp"
+
+#include <cstring>
+
+namespace
+{
+    const char Magic[4] = { 'X', 'Y', 'I', 'R' };
+    const std::uint32_t Version(1);
+
+    const std::uint8_t KeysChanged(1 << 7);
+    static_assert(PlayerCount < 7, "Recording flags have one bit per player");
+
+    constexpr std::size_t KeyBytes((sf::Keyboard::KeyCount + 7) / 8);
+
+    template<typename T>
+    void writeValue(std::ofstream& file, const T& value)
+    {
+        file.write(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    template<typename T>
+    bool readValue(std::ifstream& file, T& value)
+    {
+        return static_cast<bool>(file.read(reinterpret_cast<char*>(&value), sizeof(T)));
+    }
+}
+
+bool InputRecorder::open(const std::string& path, int seed, float timestep)
+{
+    m_file.open(path, std::ios::binary);
+    if (!m_file)
+    {
+        LOG_ERROR("Failed to open {} for recording", path);
+        return false;
+    }
+
+    m_file.write(Magic, sizeof(Magic));
+    writeValue(m_file, Version);
+    writeValue(m_file, static_cast<std::int32_t>(seed));
+    writeValue(m_file, timestep);
+
+    m_last = {};
+    LOG_INFO("Recording input to {}", path);
+    return true;
+}
+
+void InputRecorder::write(const RecordedFrame& frame)
+{
+    if (!m_file.is_open())
+        return;
+
+    std::uint8_t flags = 0;
+    for (int i(0); i < PlayerCount; i++)
+    {
+        if (frame.movement[i] != m_last.movement[i])
+            flags |= 1 << i;
+    }
+    if (frame.keys != m_last.keys)
+        flags |= KeysChanged;
+
+    writeValue(m_file, flags);
+    for (int i(0); i < PlayerCount; i++)
+    {
+        if (flags & (1 << i))
+        {
+            writeValue(m_file, frame.movement[i].x);
+            writeValue(m_file, frame.movement[i].y);
+        }
+    }
+
+    if (flags & KeysChanged)
+    {
+        std::uint8_t bytes[KeyBytes] = {};
+        for (std::size_t k(0); k < frame.keys.size(); k++)
+        {
+            if (frame.keys[k])
+                bytes[k / 8] |= 1 << (k % 8);
+        }
+        m_file.write(reinterpret_cast<const char*>(bytes), KeyBytes);
+    }
+
+    m_last = frame;
+}
+
+bool InputPlayer::open(const std::string& path)
+{
+    m_file.open(path, std::ios::binary);
+
+    char magic[4];
+    std::uint32_t version;
+    std::int32_t seed;
+    float timestep;
+    if (!m_file.read(magic, sizeof(magic)) || std::memcmp(magic, Magic, sizeof(Magic)) != 0
+        || !readValue(m_file, version) || version != Version
+        || !readValue(m_file, seed) || !readValue(m_file, timestep) || timestep <= 0.f)
+    {
+        LOG_ERROR("{} is not a valid input recording", path);
+        m_file.close();
+        return false;
+    }
+
+    m_seed = seed;
+    m_timestep = timestep;
+    m_last = {};
+    LOG_INFO("Playing back input from {}", path);
+    return true;
+}
+
+bool InputPlayer::read(RecordedFrame& frame)
+{
+    std::uint8_t flags;
+    if (!m_file.is_open() || !readValue(m_file, flags))
+        return false;
+
+    for (int i(0); i < PlayerCount; i++)
+    {
+        if ((flags & (1 << i)) && !(readValue(m_file, m_last.movement[i].x) && readValue(m_file, m_last.movement[i].y)))
+            return false;
+    }
+
+    if (flags & KeysChanged)
+    {
+        std::uint8_t bytes[KeyBytes];
+        if (!m_file.read(reinterpret_cast<char*>(bytes), KeyBytes))
+            return false;
+
+        for (std::size_t k(0); k < m_last.keys.size(); k++)
+            m_last.keys[k] = (bytes[k / 8] >> (k % 8)) & 1;
+    }
+
+    frame = m_last;
+    return true;
+}
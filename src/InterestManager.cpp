@@ -0,0 +1,149 @@
+#include "InterestManager.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+
+#include "Profiler.hpp"
+#include "TerrainRenderer.hpp"
+
+namespace
+{
+    const float ChunkWorldSize(ChunkSize * TileSize);
+    const std::vector<std::size_t> NothingRelevant;
+
+    // Distance from the nearest point of one chunk to the centre of another
+    float chunkDistance(sf::Vector2i from, sf::Vector2i to)
+    {
+        sf::Vector2f centre((to.x + 0.5f) * ChunkWorldSize, (to.y + 0.5f) * ChunkWorldSize);
+        float x = std::min(std::max(centre.x, from.x * ChunkWorldSize), (from.x + 1) * ChunkWorldSize);
+        float y = std::min(std::max(centre.y, from.y * ChunkWorldSize), (from.y + 1) * ChunkWorldSize);
+        return std::hypot(centre.x - x, centre.y - y);
+    }
+}
+
+void InterestManager::setFocus(std::uint32_t client, sf::Vector2f position)
+{
+    auto chunk = chunkAt(position);
+
+    auto existing = m_subscribers.find(client);
+    bool isNew = existing == m_subscribers.end();
+    auto& subscriber = m_subscribers[client];
+    subscriber.focus = position;
+
+    if (!isNew && subscriber.focusChunk == chunk)
+        return;
+
+    PROFILE_SCOPE("InterestManager::resubscribe");
+    subscriber.focusChunk = chunk;
+
+    // Every chunk the client could have loaded from anywhere in its focus chunk, so moving
+    // about inside it never needs a resubscribe. A little wider than what it really has loaded.
+    std::vector<std::int64_t> chunks;
+    for (int y(-StreamRadius); y <= StreamRadius; y++)
+    {
+        for (int x(-StreamRadius); x <= StreamRadius; x++)
+        {
+            sf::Vector2i index(chunk.x + x, chunk.y + y);
+            if ((std::abs(x) <= 1 && std::abs(y) <= 1) || chunkDistance(chunk, index) <= DrawDistance)
+                chunks.push_back(chunkKey(index));
+        }
+    }
+    std::sort(chunks.begin(), chunks.end());
+
+    // Only touch the chunks which differ
+    std::vector<std::int64_t> changed;
+    std::set_difference(subscriber.chunks.begin(), subscriber.chunks.end(), chunks.begin(), chunks.end(), std::back_inserter(changed));
+    for (auto key : changed)
+    {
+        unsubscribe(client, key);
+    }
+
+    changed.clear();
+    std::set_difference(chunks.begin(), chunks.end(), subscriber.chunks.begin(), subscriber.chunks.end(), std::back_inserter(changed));
+    for (auto key : changed)
+    {
+        subscribe(client, key);
+    }
+
+    subscriber.chunks.swap(chunks);
+}
+
+void InterestManager::removeClient(std::uint32_t client)
+{
+    auto subscriber = m_subscribers.find(client);
+    if (subscriber == m_subscribers.end())
+        return;
+
+    for (auto key : subscriber->second.chunks)
+    {
+        unsubscribe(client, key);
+    }
+    m_subscribers.erase(subscriber);
+}
+
+void InterestManager::update(const Snapshot& snapshot)
+{
+    PROFILE_SCOPE("InterestManager::update");
+
+    for (auto& subscriber : m_subscribers)
+    {
+        subscriber.second.relevant.clear();
+    }
+
+    // One lookup per entity, then an append per subscriber it's actually sent to
+    // Consecutive entities are often in the same chunk, so the last lookup is reused
+    std::int64_t lastKey = 0;
+    const std::vector<std::uint32_t>* lastSubscribers = nullptr;
+    bool hasLast = false;
+
+    for (std::size_t i(0); i < snapshot.entities.size(); i++)
+    {
+        auto key = chunkKey(snapshot.entities[i].chunk);
+        if (!hasLast || key != lastKey)
+        {
+            auto found = m_chunkSubscribers.find(key);
+            lastSubscribers = found != m_chunkSubscribers.end() ? &found->second : nullptr;
+            lastKey = key;
+            hasLast = true;
+        }
+
+        if (!lastSubscribers)
+            continue;
+
+        for (auto client : *lastSubscribers)
+        {
+            m_subscribers[client].relevant.push_back(i);
+        }
+    }
+}
+
+const std::vector<std::size_t>& InterestManager::getRelevant(std::uint32_t client) const
+{
+    auto subscriber = m_subscribers.find(client);
+    return subscriber != m_subscribers.end() ? subscriber->second.relevant : NothingRelevant;
+}
+
+sf::Vector2f InterestManager::getFocus(std::uint32_t client) const
+{
+    auto subscriber = m_subscribers.find(client);
+    return subscriber != m_subscribers.end() ? subscriber->second.focus : sf::Vector2f();
+}
+
+//private
+void InterestManager::subscribe(std::uint32_t client, std::int64_t chunk)
+{
+    m_chunkSubscribers[chunk].push_back(client);
+}
+
+void InterestManager::unsubscribe(std::uint32_t client, std::int64_t chunk)
+{
+    auto subscribers = m_chunkSubscribers.find(chunk);
+    if (subscribers == m_chunkSubscribers.end())
+        return;
+
+    auto& list = subscribers->second;
+    list.erase(std::remove(list.begin(), list.end(), client), list.end());
+    if (list.empty())
+        m_chunkSubscribers.erase(subscribers);
+}
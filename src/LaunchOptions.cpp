@@ -0,0 +1,55 @@
+#include "LaunchOptions.hpp"
+#include "Log.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+
+namespace
+{
+    LaunchOptions options;
+}
+
+void parseLaunchOptions(int argc, char** argv)
+{
+    for (int i(1); i < argc; i++)
+    {
+        std::string arg(argv[i]);
+        bool hasValue = i + 1 < argc;
+
+        if (arg == "--seed" && hasValue)
+            options.seed = std::atoi(argv[++i]);
+        else if (arg == "--tick-rate" && hasValue)
+            options.tickRate = std::max(1.f, static_cast<float>(std::atof(argv[++i])));
+        else if (arg == "--pipelined")
+            options.pipelined = true;
+        else if (arg == "--ticks" && hasValue)
+            options.tickLimit = std::atoi(argv[++i]);
+        else if (arg == "--unthrottled")
+            options.unthrottled = true;
+        else if (arg == "--bots" && hasValue)
+            options.bots = std::max(0, std::atoi(argv[++i]));
+        else if (arg == "--clients" && hasValue)
+            options.clients = std::max(0, std::atoi(argv[++i]));
+        else if (arg == "--record" && hasValue)
+            options.recordPath = argv[++i];
+        else if (arg == "--playback" && hasValue)
+            options.playbackPath = argv[++i];
+        else if (arg == "--port" && hasValue)
+            options.port = static_cast<unsigned short>(std::atoi(argv[++i]));
+        else if (arg == "--connect" && hasValue)
+            options.connectAddress = argv[++i];
+        else if (arg == "--sim-loss" && hasValue)
+            options.simLoss = std::min(std::max(static_cast<float>(std::atof(argv[++i])) / 100.f, 0.f), 1.f);
+        else if (arg == "--sim-latency" && hasValue)
+            options.simLatency = std::max(0.f, static_cast<float>(std::atof(argv[++i])) / 1000.f);
+        else if (arg == "--sim-jitter" && hasValue)
+            options.simJitter = std::max(0.f, static_cast<float>(std::atof(argv[++i])) / 1000.f);
+        else
+            LOG_WARNING("Ignoring unknown option {}", arg);
+    }
+}
+
+const LaunchOptions& getLaunchOptions()
+{
+    return options;
+}
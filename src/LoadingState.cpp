@@ -0,0 +1,146 @@
+#include "LoadingState.hpp"
+
+#include <SFML/Graphics/RectangleShape.hpp>
+#include <SFML/Graphics/RenderWindow.hpp>
+
+#include <array>
+
+#include "LaunchOptions.hpp"
+#include "Log.hpp"
+#include "NetDatagrams.hpp"
+#include "NetProtocol.hpp"
+#include "Profiler.hpp"
+
+namespace
+{
+    const sf::Vector2f ProgressBarSize(400.f, 16.f);
+
+    // Null when not joining a server, or when the server couldn't be joined and the game falls back to a local world
+    std::unique_ptr<WorldClient> joinServer()
+    {
+        const auto& options = getLaunchOptions();
+        if (options.connectAddress.empty())
+            return nullptr;
+
+        auto client = std::make_unique<WorldClient>(getSimulatedConditions());
+        if (!client->join(options.connectAddress, options.port ? options.port : DefaultPort))
+        {
+            LOG_WARNING("Playing offline");
+            return nullptr;
+        }
+        return client;
+    }
+
+    // Runs on a worker, the chunks are each generated on another
+    void prepareWorld(Preload& preload)
+    {
+        PROFILE_SCOPE("LoadingState::prepareWorld");
+
+        preload.client = joinServer();
+
+        // A playback's seed is only known once World reads the recording
+        const auto& options = getLaunchOptions();
+        if (!options.playbackPath.empty())
+            return;
+
+        preload.params = preload.client ? preload.client->getParams() : TerrainGenerator::defaultParams(options.seed);
+        TerrainGenerator generator(preload.params);
+
+        // The player starts at the origin
+        auto centre = chunkAt({});
+        preload.chunks.resize(9);
+
+        std::array<std::future<void>, 9> chunks;
+        for (int i(0); i < 9; i++)
+        {
+            sf::Vector2i index(centre.x + i % 3 - 1, centre.y + i / 3 - 1);
+            chunks[i] = std::async(std::launch::async, [&generator, &preload, i, index]()
+            {
+                generator.generate(preload.chunks[i], index);
+            });
+        }
+
+        for (auto& chunk : chunks)
+        {
+            chunk.get();
+        }
+    }
+}
+
+LoadingState::LoadingState(xy::StateStack& stack, xy::State::Context ctx, Preload& preload)
+    : xy::State(stack, ctx),
+    m_preload(preload),
+    m_assetsReady(false),
+    m_worldReady(false),
+    m_finished(false)
+{
+    if (!m_preload.assets.openArchive(AssetPaths::Archive))
+        LOG_INFO("No asset archive, loading loose files");
+
+    m_preload.assets.queueImage(AssetPaths::TerrainSheet);
+
+    m_world = std::async(std::launch::async, prepareWorld, std::ref(m_preload));
+}
+
+//public
+bool LoadingState::handleEvent(const sf::Event&)
+{
+    return false;
+}
+
+void LoadingState::handleMessage(const xy::Message&)
+{
+
+}
+
+bool LoadingState::update(float)
+{
+    bool assetsLoaded = m_preload.assets.update();
+    if (assetsLoaded && !m_assetsReady)
+    {
+        // On its own as well, as the world usually takes longer and hides it
+        m_assetsReady = true;
+        auto elapsed = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - m_preload.launchTime);
+        LOG_INFO("Assets loaded in {}ms", elapsed.count());
+    }
+
+    if (!m_worldReady && m_world.wait_for(std::chrono::seconds(0)) == std::future_status::ready)
+    {
+        m_world.get();
+        m_worldReady = true;
+    }
+
+    if (assetsLoaded && m_worldReady && !m_finished)
+    {
+        m_finished = true;
+
+        auto elapsed = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - m_preload.launchTime);
+        LOG_INFO("Loaded {} chunks and assets in {}ms", m_preload.chunks.size(), elapsed.count());
+
+        requestStackPop();
+        requestStackPush(States::WorldPlayState);
+    }
+    return false;
+}
+
+void LoadingState::draw()
+{
+    auto& rw = getContext().renderWindow;
+    rw.setView(rw.getDefaultView());
+
+    // The world counts as much as all the assets, it's usually the longer of the two
+    float progress = (m_preload.assets.getProgress() + (m_worldReady ? 1.f : 0.f)) / 2.f;
+
+    sf::Vector2f centre(rw.getSize().x / 2.f, rw.getSize().y / 2.f);
+    sf::RectangleShape bar(ProgressBarSize);
+    bar.setPosition(centre - ProgressBarSize / 2.f);
+    bar.setFillColor(sf::Color::Transparent);
+    bar.setOutlineColor(sf::Color::White);
+    bar.setOutlineThickness(2.f);
+    rw.draw(bar);
+
+    bar.setSize({ ProgressBarSize.x * progress, ProgressBarSize.y });
+    bar.setFillColor(sf::Color::White);
+    bar.setOutlineThickness(0.f);
+    rw.draw(bar);
+}
@@ -0,0 +1,229 @@
+#include "Log.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    // Single producer (the owning thread), single consumer (the writer)
+    struct ThreadRing
+    {
+        std::array<Log::Record, Log::RingSize> records;
+        std::atomic<std::uint64_t> head{ 0 };
+        std::atomic<std::uint64_t> tail{ 0 };
+        std::atomic<std::uint64_t> dropped{ 0 };
+        std::uint64_t droppedReported = 0; // writer only
+    };
+
+    // How long the writer sleeps when there's nothing to write
+    const std::chrono::milliseconds WriterInterval(5);
+
+    std::mutex registryMutex;
+    std::vector<std::shared_ptr<ThreadRing>> registry;
+
+    std::mutex writerMutex;
+    std::condition_variable writerCondition;
+    std::thread writerThread;
+    bool writerRunning = false;
+
+    ThreadRing& localRing()
+    {
+        thread_local std::shared_ptr<ThreadRing> ring = []()
+        {
+            auto newRing = std::make_shared<ThreadRing>();
+
+            std::lock_guard<std::mutex> lock(registryMutex);
+            registry.push_back(newRing);
+            return newRing;
+        }();
+        return *ring;
+    }
+
+    void format(std::ostream& os, const Log::Record& record)
+    {
+        switch (record.level)
+        {
+        case Log::Level::Debug:
+            os << "DEBUG: ";
+            break;
+        case Log::Level::Info:
+            os << "INFO: ";
+            break;
+        case Log::Level::Warning:
+            os << "WARNING: ";
+            break;
+        case Log::Level::Error:
+            os << "ERROR: ";
+            break;
+        }
+
+        std::size_t arg = 0;
+        for (auto c = record.format; *c; c++)
+        {
+            if (c[0] == '{' && c[1] == '}' && arg < record.argCount)
+            {
+                const auto& a = record.args[arg++];
+                switch (a.type)
+                {
+                case Log::Arg::Int:
+                    os << a.i;
+                    break;
+                case Log::Arg::UInt:
+                    os << a.u;
+                    break;
+                case Log::Arg::Float:
+                    os << a.f;
+                    break;
+                case Log::Arg::Bool:
+                    os << (a.u ? "true" : "false");
+                    break;
+                case Log::Arg::Char:
+                    os << static_cast<char>(a.i);
+                    break;
+                case Log::Arg::Text:
+                    os.write(record.text + a.text.offset, a.text.length);
+                    break;
+                }
+                c++;
+            }
+            else
+            {
+                os << *c;
+            }
+        }
+        os << '\n';
+    }
+
+    // Formats and writes everything currently queued, returns false if there was nothing
+    bool drain()
+    {
+        std::vector<std::shared_ptr<ThreadRing>> rings;
+        {
+            std::lock_guard<std::mutex> lock(registryMutex);
+            rings = registry;
+        }
+
+        std::ostringstream out;
+        std::ostringstream err;
+
+        for (auto& ring : rings)
+        {
+            auto tail = ring->tail.load(std::memory_order_relaxed);
+            auto head = ring->head.load(std::memory_order_acquire);
+
+            for (; tail != head; tail++)
+            {
+                const auto& record = ring->records[tail % Log::RingSize];
+                format(record.level >= Log::Level::Warning ? err : out, record);
+            }
+            ring->tail.store(tail, std::memory_order_release);
+
+            auto dropped = ring->dropped.load(std::memory_order_relaxed);
+            if (dropped != ring->droppedReported)
+            {
+                err << "WARNING: " << dropped - ring->droppedReported << " log messages dropped\n";
+                ring->droppedReported = dropped;
+            }
+        }
+
+        auto outText = out.str();
+        auto errText = err.str();
+        if (!outText.empty())
+            std::cout << outText << std::flush;
+        if (!errText.empty())
+            std::cerr << errText << std::flush;
+
+        return !outText.empty() || !errText.empty();
+    }
+
+    void writerLoop()
+    {
+        std::unique_lock<std::mutex> lock(writerMutex);
+        while (writerRunning)
+        {
+            lock.unlock();
+            bool wrote = drain();
+            lock.lock();
+
+            if (!wrote)
+                writerCondition.wait_for(lock, WriterInterval);
+        }
+        lock.unlock();
+
+        drain();
+    }
+}
+
+void Log::start()
+{
+    std::lock_guard<std::mutex> lock(writerMutex);
+    if (!writerRunning)
+    {
+        writerRunning = true;
+        writerThread = std::thread(writerLoop);
+    }
+}
+
+void Log::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(writerMutex);
+        writerRunning = false;
+    }
+    writerCondition.notify_one();
+
+    if (writerThread.joinable())
+        writerThread.join();
+    else
+        drain();
+}
+
+std::uint64_t Log::getDroppedCount()
+{
+    std::lock_guard<std::mutex> lock(registryMutex);
+
+    std::uint64_t count = 0;
+    for (const auto& ring : registry)
+        count += ring->dropped.load(std::memory_order_relaxed);
+    return count;
+}
+
+Log::Record* Log::Detail::beginRecord()
+{
+    auto& ring = localRing();
+    auto head = ring.head.load(std::memory_order_relaxed);
+
+    if (head - ring.tail.load(std::memory_order_acquire) >= RingSize)
+    {
+        ring.dropped.fetch_add(1, std::memory_order_relaxed);
+        return nullptr;
+    }
+    return &ring.records[head % RingSize];
+}
+
+void Log::Detail::commitRecord()
+{
+    auto& ring = localRing();
+    ring.head.store(ring.head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+void Log::Detail::packText(Record& record, const char* str, std::size_t length)
+{
+    auto& a = record.args[record.argCount++];
+    a.type = Arg::Text;
+    a.text.offset = record.textUsed;
+    a.text.length = static_cast<std::uint16_t>(std::min(length, TextSize - record.textUsed));
+
+    std::memcpy(record.text + a.text.offset, str, a.text.length);
+    record.textUsed += a.text.length;
+}
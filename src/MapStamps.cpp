@@ -0,0 +1,167 @@
+#include "MapStamps.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+#include "Log.hpp"
+#include "Profiler.hpp"
+#include "TileMap.hpp"
+
+namespace
+{
+    // Stamped tiles the generator made sea are raised just above sea level, as edits do, since meshing goes by height
+    const float StampedLandHeight(SeaLevel + 0.01f);
+
+    const int MaskWords(TileCount / 64);
+}
+
+void MapStamps::add(const TileMap& map, sf::Vector2i tile)
+{
+    auto size = map.getSize();
+    if (size.x <= 0 || size.y <= 0)
+        return;
+
+    auto layerCount = static_cast<int>(map.getLayerNames().size());
+    if (layerCount > OverlayLayers)
+    {
+        LOG_WARNING("Map has {} layers, only the first {} are stamped", layerCount, OverlayLayers);
+        layerCount = OverlayLayers;
+    }
+
+    sf::Vector2i first(floorDiv(tile.x, ChunkSize), floorDiv(tile.y, ChunkSize));
+    sf::Vector2i last(floorDiv(tile.x + size.x - 1, ChunkSize), floorDiv(tile.y + size.y - 1, ChunkSize));
+
+    for (int cy(first.y); cy <= last.y; cy++)
+    {
+        for (int cx(first.x); cx <= last.x; cx++)
+        {
+            // The map's rectangle clipped to the chunk, in world tiles
+            int left = std::max(tile.x, cx * ChunkSize);
+            int top = std::max(tile.y, cy * ChunkSize);
+            int right = std::min(tile.x + size.x, (cx + 1) * ChunkSize);
+            int bottom = std::min(tile.y + size.y, (cy + 1) * ChunkSize);
+
+            Slice slice;
+            slice.left = left - cx * ChunkSize;
+            slice.top = top - cy * ChunkSize;
+            slice.width = right - left;
+            slice.height = bottom - top;
+
+            auto area = slice.width * slice.height;
+            slice.tiles.assign(std::size_t(OverlayLayers) * area, 0);
+            slice.covered.assign(MaskWords, 0);
+            slice.bounds.assign(MaskWords, 0);
+
+            for (int y(0); y < slice.height; y++)
+            {
+                for (int x(0); x < slice.width; x++)
+                {
+                    int mapX = left + x - tile.x;
+                    int mapY = top + y - tile.y;
+                    const auto* piece = map.getPiece({ mapX / ChunkSize, mapY / ChunkSize });
+                    int source = (mapY % ChunkSize) * ChunkSize + mapX % ChunkSize;
+
+                    int i = (slice.top + y) * ChunkSize + slice.left + x;
+                    auto bit = std::uint64_t(1) << (i & 63);
+                    slice.bounds[i >> 6] |= bit;
+
+                    for (int layer(0); piece && layer < layerCount; layer++)
+                    {
+                        auto value = piece->layers[layer][source];
+                        slice.tiles[layer * area + y * slice.width + x] = value;
+                        if (value)
+                            slice.covered[i >> 6] |= bit;
+                    }
+                }
+            }
+
+            m_chunks[chunkKey({ cx, cy })].push_back(std::move(slice));
+        }
+    }
+
+    m_count++;
+    LOG_INFO("Stamped a {}x{} map at {},{} over {} chunks", size.x, size.y, tile.x, tile.y,
+        (last.x - first.x + 1) * (last.y - first.y + 1));
+}
+
+bool MapStamps::overlaps(sf::Vector2i index) const
+{
+    return m_chunks.count(chunkKey(index)) != 0;
+}
+
+void MapStamps::applyTo(TerrainChunk& chunk) const
+{
+    auto found = m_chunks.find(chunkKey(chunk.getIndex()));
+    if (found == m_chunks.end())
+        return;
+
+    PROFILE_SCOPE("MapStamps::applyTo");
+
+    chunk.overlay.resize(std::size_t(OverlayLayers) * TileCount);
+
+    for (const auto& slice : found->second)
+    {
+        auto area = slice.width * slice.height;
+        for (int layer(0); layer < OverlayLayers; layer++)
+        {
+            const auto* src = slice.tiles.data() + layer * area;
+            auto* dst = chunk.overlay.data() + layer * TileCount + slice.top * ChunkSize + slice.left;
+
+            // Slices spanning the chunk are contiguous
+            if (slice.width == ChunkSize)
+            {
+                std::memcpy(dst, src, area * sizeof(std::uint16_t));
+            }
+            else
+            {
+                for (int y(0); y < slice.height; y++)
+                {
+                    std::memcpy(dst + y * ChunkSize, src + y * slice.width, slice.width * sizeof(std::uint16_t));
+                }
+            }
+        }
+
+        // A later slice owns its whole rectangle, tiles it leaves empty drop an earlier stamp's
+        for (int w(0); w < MaskWords; w++)
+        {
+            chunk.stamped[w] = (chunk.stamped[w] & ~slice.bounds[w]) | slice.covered[w];
+        }
+    }
+
+    // Land is left alone until every slice is in, so a stamp's empty tiles keep whatever was generated under them
+    for (int w(0); w < MaskWords; w++)
+    {
+        auto stamped = chunk.stamped[w];
+        if (!stamped)
+            continue;
+
+        chunk.land[w] |= stamped;
+        for (int b(0); b < 64; b++)
+        {
+            int i = w * 64 + b;
+            if (((stamped >> b) & 1) && chunk.height[i] <= SeaLevel)
+            {
+                chunk.height[i] = StampedLandHeight;
+                chunk.biome[i] = Biome::Beach;
+            }
+        }
+    }
+}
+
+bool MapStamps::covers(int tileX, int tileY) const
+{
+    sf::Vector2i index(floorDiv(tileX, ChunkSize), floorDiv(tileY, ChunkSize));
+    auto found = m_chunks.find(chunkKey(index));
+    if (found == m_chunks.end())
+        return false;
+
+    int i = (tileY - index.y * ChunkSize) * ChunkSize + (tileX - index.x * ChunkSize);
+
+    // Whichever stamp was placed last over the tile decides it, as in applyTo()
+    for (auto slice = found->second.rbegin(); slice != found->second.rend(); ++slice)
+    {
+        if ((slice->bounds[i >> 6] >> (i & 63)) & 1)
+            return (slice->covered[i >> 6] >> (i & 63)) & 1;
+    }
+    return false;
+}
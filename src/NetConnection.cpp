@@ -0,0 +1,60 @@
+#include "NetConnection.hpp"
+
+namespace
+{
+    // sf::Packet's length prefix
+    const std::size_t PacketHeaderSize(4);
+}
+
+void NetConnection::send(const sf::Packet& packet)
+{
+    if (!m_connected)
+        return;
+
+    m_outgoing.push_back(packet);
+    flush();
+}
+
+bool NetConnection::flush()
+{
+    m_socket.setBlocking(false);
+    while (m_connected && !m_outgoing.empty())
+    {
+        // A partial send has to be retried with the same packet, which remembers how far it got
+        auto& packet = m_outgoing.front();
+        auto status = m_socket.send(packet);
+        if (status == sf::Socket::Done)
+        {
+            m_bytesSent += packet.getDataSize() + PacketHeaderSize;
+            m_outgoing.pop_front();
+        }
+        else if (status == sf::Socket::Partial || status == sf::Socket::NotReady)
+        {
+            break;
+        }
+        else
+        {
+            m_connected = false;
+        }
+    }
+    return m_connected;
+}
+
+bool NetConnection::receive(sf::Packet& packet)
+{
+    if (!m_connected)
+        return false;
+
+    m_socket.setBlocking(false);
+    auto status = m_socket.receive(packet);
+    if (status == sf::Socket::Done)
+    {
+        m_bytesReceived += packet.getDataSize() + PacketHeaderSize;
+        return true;
+    }
+
+    if (status == sf::Socket::Disconnected || status == sf::Socket::Error)
+        m_connected = false;
+
+    return false;
+}
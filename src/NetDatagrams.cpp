@@ -0,0 +1,80 @@
+#include "NetDatagrams.hpp"
+
+#include <algorithm>
+
+#include "LaunchOptions.hpp"
+#include "Log.hpp"
+
+LinkConditions getSimulatedConditions()
+{
+    const auto& options = getLaunchOptions();
+    LinkConditions conditions;
+    conditions.loss = options.simLoss;
+    conditions.latency = options.simLatency;
+    conditions.jitter = options.simJitter;
+
+    if (conditions.loss > 0.f || conditions.latency > 0.f || conditions.jitter > 0.f)
+    {
+        LOG_INFO("Simulating {}% loss, {}ms latency and {}ms jitter",
+            conditions.loss * 100.f, conditions.latency * 1000.f, conditions.jitter * 1000.f);
+    }
+    return conditions;
+}
+
+NetDatagrams::NetDatagrams(const LinkConditions& conditions) :
+    m_conditions(conditions),
+    m_random(std::random_device()()),
+    m_receiveBuffer(sf::UdpSocket::MaxDatagramSize),
+    m_bytesSent(0)
+{
+    m_socket.setBlocking(false);
+}
+
+bool NetDatagrams::bind(unsigned short port)
+{
+    return m_socket.bind(port) == sf::Socket::Done;
+}
+
+void NetDatagrams::send(const std::vector<std::uint8_t>& data, const sf::IpAddress& address, unsigned short port)
+{
+    std::uniform_real_distribution<float> chance(0.f, 1.f);
+    if (m_conditions.loss > 0.f && chance(m_random) < m_conditions.loss)
+        return;
+
+    if (m_conditions.latency <= 0.f && m_conditions.jitter <= 0.f)
+    {
+        if (m_socket.send(data.data(), data.size(), address, port) == sf::Socket::Done)
+            m_bytesSent += data.size();
+        return;
+    }
+
+    Delayed delayed;
+    delayed.due = Clock::now() + std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<float>(m_conditions.latency + m_conditions.jitter * chance(m_random)));
+    delayed.data = data;
+    delayed.address = address;
+    delayed.port = port;
+    m_delayed.push_back(std::move(delayed));
+}
+
+void NetDatagrams::update()
+{
+    auto now = Clock::now();
+    auto due = std::stable_partition(m_delayed.begin(), m_delayed.end(), [now](const Delayed& d) { return d.due > now; });
+    std::sort(due, m_delayed.end(), [](const Delayed& a, const Delayed& b) { return a.due < b.due; });
+    for (auto d = due; d != m_delayed.end(); ++d)
+    {
+        if (m_socket.send(d->data.data(), d->data.size(), d->address, d->port) == sf::Socket::Done)
+            m_bytesSent += d->data.size();
+    }
+    m_delayed.erase(due, m_delayed.end());
+}
+
+bool NetDatagrams::receive(const std::uint8_t*& data, std::size_t& size, sf::IpAddress& address, unsigned short& port)
+{
+    if (m_socket.receive(m_receiveBuffer.data(), m_receiveBuffer.size(), size, address, port) != sf::Socket::Done)
+        return false;
+
+    data = m_receiveBuffer.data();
+    return true;
+}
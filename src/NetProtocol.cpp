@@ -0,0 +1,67 @@
+#include "NetProtocol.hpp"
+
+sf::Packet& operator << (sf::Packet& packet, sf::Vector2i v)
+{
+    return packet << static_cast<sf::Int32>(v.x) << static_cast<sf::Int32>(v.y);
+}
+
+sf::Packet& operator >> (sf::Packet& packet, sf::Vector2i& v)
+{
+    sf::Int32 x = 0, y = 0;
+    packet >> x >> y;
+    v = { x, y };
+    return packet;
+}
+
+sf::Packet& operator << (sf::Packet& packet, const TileEdit& edit)
+{
+    return packet << static_cast<sf::Int32>(edit.x) << static_cast<sf::Int32>(edit.y) << edit.land;
+}
+
+sf::Packet& operator >> (sf::Packet& packet, TileEdit& edit)
+{
+    sf::Int32 x = 0, y = 0;
+    packet >> x >> y >> edit.land;
+    edit.x = x;
+    edit.y = y;
+    return packet;
+}
+
+sf::Packet& operator << (sf::Packet& packet, const TerrainGenerator::Params& params)
+{
+    packet << static_cast<sf::Int32>(params.seed);
+    for (const auto& p : params.layers)
+    {
+        packet << p.frequency << static_cast<sf::Int32>(p.octaves) << p.lacunarity << p.gain << p.cellularJitter;
+        packet << p.noiseType << p.fractalType << p.interp << p.cellularDistance << p.cellularReturn;
+    }
+    return packet;
+}
+
+sf::Packet& operator >> (sf::Packet& packet, TerrainGenerator::Params& params)
+{
+    sf::Int32 seed = 0;
+    packet >> seed;
+    params.seed = seed;
+
+    for (auto& p : params.layers)
+    {
+        sf::Int32 octaves = 0;
+        packet >> p.frequency >> octaves >> p.lacunarity >> p.gain >> p.cellularJitter;
+        packet >> p.noiseType >> p.fractalType >> p.interp >> p.cellularDistance >> p.cellularReturn;
+        p.octaves = octaves;
+    }
+    return packet;
+}
+
+void writeHash(sf::Packet& packet, std::uint64_t hash)
+{
+    packet << static_cast<sf::Uint64>(hash);
+}
+
+std::uint64_t readHash(sf::Packet& packet)
+{
+    sf::Uint64 hash = 0;
+    packet >> hash;
+    return hash;
+}
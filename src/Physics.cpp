@@ -1,7 +1,20 @@
 #include "Physics.hpp"
 
 #include <xyginext/ecs/components/Transform.hpp>
+
+#include <algorithm>
+#include <future>
+#include <thread>
+
 #include "Velocity.hpp"
+#include "Profiler.hpp"
+
+namespace
+{
+    // Integration costs around 1.6ns a body and starting a worker 15-25us (bench/PhysicsBench.cpp),
+    // so a worker only pays for itself past about 16k bodies. Twice that leaves it a clear win.
+    const std::size_t MinBodiesPerWorker(1 << 15);
+}
 
 Physics::Physics(xy::MessageBus& mb) :
     xy::System(mb, typeid(Physics))
@@ -12,8 +25,129 @@ Physics::Physics(xy::MessageBus& mb) :
 
 void Physics::process(float dt)
 {
-    for (auto& ent : getEntities())
+    PROFILE_SCOPE("Physics::process");
+
+    std::size_t count = m_bodies.size();
+    float* px = m_positionX.data();
+    float* py = m_positionY.data();
+    const float* vx = m_velocityX.data();
+    const float* vy = m_velocityY.data();
+
+    std::size_t workers = std::min<std::size_t>(std::max(1u, std::thread::hardware_concurrency()), count / MinBodiesPerWorker);
+
+    if (workers > 1)
+    {
+        // This thread takes the first slice
+        std::vector<std::future<void>> slices;
+        std::size_t sliceSize = (count + workers - 1) / workers;
+        for (std::size_t begin = sliceSize; begin < count; begin += sliceSize)
+        {
+            slices.push_back(std::async(std::launch::async, &Physics::integrate, px, py, vx, vy, begin, std::min(begin + sliceSize, count), dt));
+        }
+        integrate(px, py, vx, vy, 0, sliceSize, dt);
+
+        for (auto& slice : slices)
+            slice.wait();
+    }
+    else
+    {
+        integrate(px, py, vx, vy, 0, count, dt);
+    }
+
+    // Write back in one pass, resting bodies keep their transforms clean
+    for (std::size_t i(0); i < count; i++)
+    {
+        if (m_velocityX[i] != 0.f || m_velocityY[i] != 0.f)
+        {
+            m_bodies[i].getComponent<xy::Transform>().setPosition(m_positionX[i], m_positionY[i]);
+        }
+    }
+}
+
+void Physics::setVelocity(xy::Entity entity, sf::Vector2f velocity)
+{
+    auto result = m_bodyIndices.find(entity.getIndex());
+    if (result != m_bodyIndices.end())
+    {
+        m_velocityX[result->second] = velocity.x;
+        m_velocityY[result->second] = velocity.y;
+        entity.getComponent<Velocity>() = velocity;
+    }
+}
+
+sf::Vector2f Physics::getVelocity(xy::Entity entity) const
+{
+    auto result = m_bodyIndices.find(entity.getIndex());
+    if (result != m_bodyIndices.end())
     {
-        ent.getComponent<xy::Transform>().move(ent.getComponent<Velocity>()*dt);
+        return { m_velocityX[result->second], m_velocityY[result->second] };
     }
-}
\ No newline at end of file
+    return {};
+}
+
+void Physics::setPosition(xy::Entity entity, sf::Vector2f position)
+{
+    auto result = m_bodyIndices.find(entity.getIndex());
+    if (result != m_bodyIndices.end())
+    {
+        m_positionX[result->second] = position.x;
+        m_positionY[result->second] = position.y;
+        entity.getComponent<xy::Transform>().setPosition(position);
+    }
+}
+
+void Physics::integrate(float* x, float* y, const float* vx, const float* vy, std::size_t begin, std::size_t end, float dt)
+{
+    // Plain indexed loops over separate arrays so the compiler vectorises them
+    for (auto i = begin; i < end; i++)
+        x[i] += vx[i] * dt;
+    for (auto i = begin; i < end; i++)
+        y[i] += vy[i] * dt;
+}
+
+std::size_t Physics::getMinBodiesPerWorker()
+{
+    return MinBodiesPerWorker;
+}
+
+//private
+void Physics::onEntityAdded(xy::Entity entity)
+{
+    auto position = entity.getComponent<xy::Transform>().getPosition();
+    const auto& velocity = entity.getComponent<Velocity>();
+
+    m_bodyIndices[entity.getIndex()] = m_bodies.size();
+    m_bodies.push_back(entity);
+    m_positionX.push_back(position.x);
+    m_positionY.push_back(position.y);
+    m_velocityX.push_back(velocity.x);
+    m_velocityY.push_back(velocity.y);
+}
+
+void Physics::onEntityRemoved(xy::Entity entity)
+{
+    auto result = m_bodyIndices.find(entity.getIndex());
+    if (result == m_bodyIndices.end())
+        return;
+
+    // Swap the last body into the gap so the arrays stay packed
+    auto index = result->second;
+    auto last = m_bodies.size() - 1;
+    m_bodyIndices.erase(result);
+
+    if (index != last)
+    {
+        m_bodies[index] = m_bodies[last];
+        m_positionX[index] = m_positionX[last];
+        m_positionY[index] = m_positionY[last];
+        m_velocityX[index] = m_velocityX[last];
+        m_velocityY[index] = m_velocityY[last];
+        m_bodyIndices[m_bodies[index].getIndex()] = index;
+    }
+
+    m_bodies.pop_back();
+    m_positionX.pop_back();
+    m_positionY.pop_back();
+    m_velocityX.pop_back();
+    m_velocityY.pop_back();
+}
@@ -0,0 +1,102 @@
+#include "PlayerController.hpp"
+
+#include <xyginext/ecs/components/Transform.hpp>
+#include <xyginext/ecs/components/SpriteAnimation.hpp>
+
+#include <cmath>
+
+#include "Log.hpp"
+#include "Profiler.hpp"
+
+namespace
+{
+    // Walk animation index for each direction in george.spt
+    enum Animation
+    {
+        WalkDown,
+        WalkLeft,
+        WalkUp,
+        WalkRight
+    };
+}
+
+PlayerController::PlayerController(xy::MessageBus& mb) :
+    xy::System(mb, typeid(PlayerController))
+{
+    requireComponent<InputState>();
+    requireComponent<xy::Transform>();
+    requireComponent<xy::SpriteAnimation>();
+}
+
+void PlayerController::process(float dt)
+{
+    PROFILE_SCOPE("PlayerController::process");
+
+    for (auto& ent : getEntities())
+    {
+        auto& input = ent.getComponent<InputState>();
+        auto& t = ent.getComponent<xy::Transform>();
+
+        LOG_DEBUG("movement = {} {}", input.movement.x, input.movement.y);
+        t.setPosition(walk(t.getPosition(), input.movement, dt));
+
+        // Animate along the dominant axis
+        int animId(-1);
+        float dx(input.movement.x), dy(input.movement.y);
+        if (std::fabs(dx) > std::fabs(dy))
+            dy = 0.f;
+        else
+            dx = 0.f;
+
+        if (dy > 0.f)
+            animId = WalkDown;
+        if (dx < 0.f)
+            animId = WalkLeft;
+        if (dy < 0.f)
+            animId = WalkUp;
+        if (dx > 0.f)
+            animId = WalkRight;
+
+        auto& a = ent.getComponent<xy::SpriteAnimation>();
+        if (animId > -1)
+        {
+            if (animId != input.animation)
+            {
+                a.stop();
+                input.animation = animId;
+            }
+            a.play(animId);
+        }
+        else
+        {
+            a.pause();
+        }
+    }
+}
+
+sf::Vector2f PlayerController::walk(sf::Vector2f position, sf::Vector2f movement, float dt)
+{
+    position += movement * PlayerSpeed * dt;
+
+    // Force it to int position to prevent artifacts
+    position.x = std::round(position.x);
+    position.y = std::round(position.y);
+    return position;
+}
+
+//private
+void PlayerController::onEntityAdded(xy::Entity ent)
+{
+    auto player = ent.getComponent<InputState>().player;
+    if (player != NoPlayer)
+        m_players[player] = ent;
+}
+
+void PlayerController::onEntityRemoved(xy::Entity ent)
+{
+    for (auto& slot : m_players)
+    {
+        if (slot == ent)
+            slot = {};
+    }
+}
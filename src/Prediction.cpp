@@ -0,0 +1,192 @@
+#include "Prediction.hpp"
+
+#include <xyginext/ecs/Scene.hpp>
+#include <xyginext/ecs/components/Transform.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+#include "Collider.hpp"
+#include "InputState.hpp"
+#include "Log.hpp"
+#include "PlayerController.hpp"
+#include "Profiler.hpp"
+#include "Snapshot.hpp"
+#include "TerrainCollision.hpp"
+
+namespace
+{
+    // Inputs kept while the server isn't acknowledging any, a few seconds' worth
+    const std::size_t MaxPendingInputs(256);
+
+    // Positions are whole units, anything less is float noise rather than a misprediction
+    const float CorrectionTolerance(0.01f);
+}
+
+InputFrame quantiseInput(std::uint16_t sequence, sf::Vector2f movement)
+{
+    auto quantiseAxis = [](float value)
+    {
+        return static_cast<std::int8_t>(std::round(std::min(std::max(value, -1.f), 1.f) * 127.f));
+    };
+
+    InputFrame frame;
+    frame.sequence = sequence;
+    frame.x = quantiseAxis(movement.x);
+    frame.y = quantiseAxis(movement.y);
+    return frame;
+}
+
+sf::Vector2f getMovement(const InputFrame& frame)
+{
+    return { frame.x / 127.f, frame.y / 127.f };
+}
+
+InputHistory::InputHistory() :
+    m_sequence(0),
+    m_hasAcknowledged(false),
+    m_acknowledged(0),
+    m_recorded(0),
+    m_reconciled(0),
+    m_corrections(0),
+    m_correctionTotal(0.0),
+    m_correctionMax(0.f),
+    m_replayedFrames(0),
+    m_replayTime(0.0),
+    m_replayTimeMax(0.0)
+{
+
+}
+
+InputFrame InputHistory::record(sf::Vector2f movement, sf::Vector2f position)
+{
+    auto frame = quantiseInput(++m_sequence, movement);
+    m_pending.push_back(frame);
+    m_starts.push_back(position);
+    m_recorded++;
+
+    if (m_pending.size() > MaxPendingInputs)
+    {
+        m_pending.pop_front();
+        m_starts.pop_front();
+    }
+    return frame;
+}
+
+bool InputHistory::reconcile(std::uint16_t acknowledged, sf::Vector2f authoritative, sf::Vector2f& current, const Step& step)
+{
+    // Snapshots which didn't move the server on, or arrived out of order, have nothing new
+    if (m_hasAcknowledged && !isNewer(acknowledged, m_acknowledged))
+        return false;
+
+    // Nothing pending is this old, so it's one which was dropped off the end, or from before a restart
+    if (m_pending.empty() || isNewer(m_pending.front().sequence, acknowledged))
+        return false;
+
+    m_hasAcknowledged = true;
+    m_acknowledged = acknowledged;
+    m_reconciled++;
+
+    while (!m_pending.empty() && !isNewer(m_pending.front().sequence, acknowledged))
+    {
+        m_pending.pop_front();
+        m_starts.pop_front();
+    }
+
+    // Where the prediction had the player after the acknowledged input, the next one's start or where it is now
+    auto predicted = m_starts.empty() ? current : m_starts.front();
+    auto error = authoritative - predicted;
+    float magnitude = std::hypot(error.x, error.y);
+    if (magnitude <= CorrectionTolerance)
+        return false;
+
+    m_corrections++;
+    m_correctionTotal += magnitude;
+    m_correctionMax = std::max(m_correctionMax, magnitude);
+
+    auto start = std::chrono::steady_clock::now();
+    auto position = authoritative;
+    for (std::size_t i(0); i < m_pending.size(); i++)
+    {
+        m_starts[i] = position;
+        position = step(position, getMovement(m_pending[i]));
+    }
+    current = position;
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    m_replayTime += seconds;
+    m_replayTimeMax = std::max(m_replayTimeMax, seconds);
+    m_replayedFrames += m_pending.size();
+    return true;
+}
+
+void InputHistory::logStats() const
+{
+    if (m_recorded == 0)
+        return;
+
+    LOG_INFO("Prediction: {} inputs, {} acknowledged, {} corrected", m_recorded, m_reconciled, m_corrections);
+    if (m_corrections == 0)
+        return;
+
+    LOG_INFO("Corrections averaged {} units, largest {}", m_correctionTotal / m_corrections, m_correctionMax);
+    LOG_INFO("Replayed {} inputs per correction, {}us each on average, {}us at most",
+        static_cast<float>(m_replayedFrames) / m_corrections, m_replayTime / m_corrections * 1000000.0, m_replayTimeMax * 1000000.0);
+}
+
+PredictionSystem::PredictionSystem(xy::MessageBus& mb) :
+    xy::System(mb, typeid(PredictionSystem)),
+    m_timestep(0.f)
+{
+    requireComponent<Predicted>();
+    requireComponent<InputState>();
+    requireComponent<xy::Transform>();
+}
+
+PredictionSystem::~PredictionSystem()
+{
+    m_history.logStats();
+}
+
+void PredictionSystem::process(float dt)
+{
+    PROFILE_SCOPE("PredictionSystem::process");
+
+    m_timestep = dt;
+    for (auto& ent : getEntities())
+    {
+        // Moves by exactly what the server will be sent
+        auto& input = ent.getComponent<InputState>();
+        auto frame = m_history.record(input.movement, ent.getComponent<xy::Transform>().getPosition());
+        input.movement = getMovement(frame);
+    }
+}
+
+void PredictionSystem::reconcile(std::uint16_t acknowledged, sf::Vector2f authoritative)
+{
+    PROFILE_SCOPE("PredictionSystem::reconcile");
+
+    auto& collision = getScene()->getSystem<TerrainCollision>();
+    for (auto& ent : getEntities())
+    {
+        auto& t = ent.getComponent<xy::Transform>();
+        bool hasCollider = ent.hasComponent<Collider>();
+        auto bounds = hasCollider ? ent.getComponent<Collider>().bounds : sf::FloatRect();
+
+        // The same movement and collision the steps themselves went through
+        auto step = [&](sf::Vector2f position, sf::Vector2f movement)
+        {
+            auto moved = PlayerController::walk(position, movement, m_timestep);
+            return hasCollider ? collision.resolve(position, moved, bounds) : moved;
+        };
+
+        auto current = t.getPosition();
+        if (m_history.reconcile(acknowledged, authoritative, current, step))
+        {
+            t.setPosition(current);
+            if (hasCollider)
+                collision.resetBody(ent);
+        }
+    }
+}
@@ -0,0 +1,147 @@
+#include "Profiler.hpp"
+
+#ifdef ENABLE_PROFILER
+
+#include "Log.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace
+{
+    struct Event
+    {
+        const char* name;
+        std::int64_t start;     // nanoseconds since StartTime
+        std::int64_t duration;  // nanoseconds
+    };
+
+    // Only the owning thread writes, head is published after each event so writeTrace() can read concurrently
+    struct ThreadRing
+    {
+        std::array<Event, Profiler::RingSize> events;
+        std::atomic<std::uint64_t> head{ 0 };
+        std::string name;
+        int id = 0;
+    };
+
+    const Profiler::Clock::time_point StartTime(Profiler::Clock::now());
+
+    // Rings are shared so threads which have exited still appear in the trace
+    std::mutex registryMutex;
+    std::vector<std::shared_ptr<ThreadRing>> registry;
+
+    ThreadRing& localRing()
+    {
+        thread_local std::shared_ptr<ThreadRing> ring = []()
+        {
+            auto newRing = std::make_shared<ThreadRing>();
+
+            std::lock_guard<std::mutex> lock(registryMutex);
+            newRing->id = static_cast<int>(registry.size());
+            newRing->name = "Thread " + std::to_string(newRing->id);
+            registry.push_back(newRing);
+            return newRing;
+        }();
+        return *ring;
+    }
+
+    std::int64_t sinceStart(Profiler::Clock::time_point time)
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(time - StartTime).count();
+    }
+
+    void writeString(std::ostream& os, const std::string& str)
+    {
+        os << '"';
+        for (auto c : str)
+        {
+            if (c == '"' || c == '\\')
+                os << '\\';
+            os << c;
+        }
+        os << '"';
+    }
+}
+
+void Profiler::record(const char* name, Clock::time_point start, Clock::time_point end)
+{
+    auto& ring = localRing();
+    auto head = ring.head.load(std::memory_order_relaxed);
+
+    auto& evt = ring.events[head % RingSize];
+    evt.name = name;
+    evt.start = sinceStart(start);
+    evt.duration = sinceStart(end) - evt.start;
+
+    ring.head.store(head + 1, std::memory_order_release);
+}
+
+void Profiler::setThreadName(const std::string& name)
+{
+    auto& ring = localRing();
+
+    std::lock_guard<std::mutex> lock(registryMutex);
+    ring.name = name;
+}
+
+bool Profiler::writeTrace(const std::string& path)
+{
+    std::ofstream file(path);
+    if (!file)
+    {
+        LOG_ERROR("Failed to open {} for writing profile", path);
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(registryMutex);
+
+    file << "{\"traceEvents\":[";
+    bool first = true;
+    std::size_t eventCount = 0;
+    std::vector<Event> events;
+
+    for (const auto& ring : registry)
+    {
+        file << (first ? "\n" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << ring->id << ",\"args\":{\"name\":";
+        writeString(file, ring->name);
+        file << "}}";
+        first = false;
+
+        // Copy what's there, then drop anything the owning thread may have overwritten meanwhile
+        auto head = ring->head.load(std::memory_order_acquire);
+        auto begin = head > RingSize ? head - RingSize : 0;
+
+        events.clear();
+        for (auto i = begin; i < head; i++)
+            events.push_back(ring->events[i % RingSize]);
+
+        auto after = ring->head.load(std::memory_order_acquire);
+        auto valid = after >= RingSize ? after - RingSize + 1 : 0;
+        auto skip = valid > begin ? std::min<std::size_t>(valid - begin, events.size()) : 0;
+
+        for (auto i = skip; i < events.size(); i++)
+        {
+            const auto& evt = events[i];
+            file << ",\n{\"name\":";
+            writeString(file, evt.name);
+            file << ",\"ph\":\"X\",\"pid\":1,\"tid\":" << ring->id
+                << ",\"ts\":" << evt.start / 1000 << '.' << (evt.start % 1000) / 100
+                << ",\"dur\":" << evt.duration / 1000 << '.' << (evt.duration % 1000) / 100 << "}";
+        }
+        eventCount += events.size() - skip;
+    }
+
+    file << "\n]}\n";
+
+    LOG_INFO("Wrote {} profile events to {}", eventCount, path);
+    return true;
+}
+
+#endif //ENABLE_PROFILER
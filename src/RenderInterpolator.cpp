@@ -0,0 +1,54 @@
+#include "RenderInterpolator.hpp"
+
+#include <xyginext/ecs/components/Transform.hpp>
+
+#include <cmath>
+
+RenderInterpolator::RenderInterpolator(xy::MessageBus& mb) :
+    xy::System(mb, typeid(RenderInterpolator))
+{
+    requireComponent<Interpolated>();
+    requireComponent<xy::Transform>();
+}
+
+void RenderInterpolator::beginStep()
+{
+    for (auto& ent : getEntities())
+    {
+        ent.getComponent<Interpolated>().previous = ent.getComponent<xy::Transform>().getPosition();
+    }
+}
+
+void RenderInterpolator::apply(float alpha)
+{
+    for (auto& ent : getEntities())
+    {
+        auto& interp = ent.getComponent<Interpolated>();
+        auto& t = ent.getComponent<xy::Transform>();
+
+        interp.current = t.getPosition();
+        auto position = interp.previous + (interp.current - interp.previous) * alpha;
+        if (interp.snapToPixels)
+        {
+            position.x = std::round(position.x);
+            position.y = std::round(position.y);
+        }
+        t.setPosition(position);
+    }
+}
+
+void RenderInterpolator::restore()
+{
+    for (auto& ent : getEntities())
+    {
+        ent.getComponent<xy::Transform>().setPosition(ent.getComponent<Interpolated>().current);
+    }
+}
+
+//private
+void RenderInterpolator::onEntityAdded(xy::Entity ent)
+{
+    // Nothing to blend from until the first step
+    auto& interp = ent.getComponent<Interpolated>();
+    interp.previous = interp.current = ent.getComponent<xy::Transform>().getPosition();
+}
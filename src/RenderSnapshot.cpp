@@ -0,0 +1,84 @@
+#include "RenderSnapshot.hpp"
+
+#include <SFML/Graphics/RenderTarget.hpp>
+#include <xyginext/ecs/Scene.hpp>
+#include <xyginext/ecs/components/Camera.hpp>
+#include <xyginext/ecs/components/Sprite.hpp>
+#include <xyginext/ecs/components/Transform.hpp>
+
+#include "Profiler.hpp"
+
+void RenderSnapshot::draw(sf::RenderTarget& rt) const
+{
+    PROFILE_SCOPE("RenderSnapshot::draw");
+
+    rt.setView(view);
+
+    sf::RenderStates states;
+    states.texture = terrainTexture;
+    for (const auto& mesh : chunks)
+    {
+        rt.draw(*mesh, states);
+    }
+
+    for (const auto& batch : batches)
+    {
+        states.texture = batch.texture;
+        rt.draw(&sprites[batch.first], batch.count, sf::PrimitiveType::Quads, states);
+    }
+}
+
+RenderCapture::RenderCapture(xy::MessageBus& mb)
+    : xy::System(mb, typeid(RenderCapture))
+{
+    requireComponent<xy::Sprite>();
+    requireComponent<xy::Transform>();
+}
+
+void RenderCapture::capture(RenderSnapshot& snapshot)
+{
+    PROFILE_SCOPE("RenderCapture::capture");
+
+    auto* scene = getScene();
+
+    // The camera's view only follows its transform when the scene is drawn, which it no longer is
+    auto camera = scene->getActiveCamera();
+    snapshot.view = camera.getComponent<xy::Camera>().getView();
+    snapshot.view.setCenter(camera.getComponent<xy::Transform>().getWorldPosition());
+
+    auto size = snapshot.view.getSize();
+    sf::FloatRect area(snapshot.view.getCenter() - size / 2.f, size);
+
+    const auto& terrain = scene->getSystem<TerrainRenderer>();
+    snapshot.terrainTexture = terrain.getTexture();
+    snapshot.chunks.clear();
+    terrain.getVisibleMeshes(area, snapshot.chunks);
+
+    snapshot.sprites.clear();
+    snapshot.batches.clear();
+    for (auto entity : getEntities())
+    {
+        const auto& sprite = entity.getComponent<xy::Sprite>();
+        const auto* texture = sprite.getTexture();
+        if (!texture)
+            continue;
+
+        auto rect = sprite.getTextureRect();
+        auto colour = sprite.getColour();
+        const auto& transform = entity.getComponent<xy::Transform>().getWorldTransform();
+
+        if (snapshot.batches.empty() || snapshot.batches.back().texture != texture)
+        {
+            RenderSnapshot::SpriteBatch batch;
+            batch.texture = texture;
+            batch.first = snapshot.sprites.size();
+            snapshot.batches.push_back(batch);
+        }
+
+        snapshot.sprites.emplace_back(transform.transformPoint(0.f, 0.f), colour, sf::Vector2f(rect.left, rect.top));
+        snapshot.sprites.emplace_back(transform.transformPoint(rect.width, 0.f), colour, sf::Vector2f(rect.left + rect.width, rect.top));
+        snapshot.sprites.emplace_back(transform.transformPoint(rect.width, rect.height), colour, sf::Vector2f(rect.left + rect.width, rect.top + rect.height));
+        snapshot.sprites.emplace_back(transform.transformPoint(0.f, rect.height), colour, sf::Vector2f(rect.left, rect.top + rect.height));
+        snapshot.batches.back().count += 4;
+    }
+}
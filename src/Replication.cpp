@@ -0,0 +1,54 @@
+#include "Replication.hpp"
+
+#include <xyginext/ecs/components/SpriteAnimation.hpp>
+#include <xyginext/ecs/components/Transform.hpp>
+
+#include <algorithm>
+
+#include "Profiler.hpp"
+
+ReplicationSystem::ReplicationSystem(xy::MessageBus& mb) :
+    xy::System(mb, typeid(ReplicationSystem)),
+    m_nextID(1)
+{
+    requireComponent<Replicated>();
+    requireComponent<xy::Transform>();
+}
+
+void ReplicationSystem::process(float dt)
+{
+    PROFILE_SCOPE("ReplicationSystem::process");
+
+    m_snapshot.sequence++;
+    m_snapshot.entities.clear();
+
+    for (auto& ent : getEntities())
+    {
+        auto& replicated = ent.getComponent<Replicated>();
+        auto position = ent.getComponent<xy::Transform>().getPosition();
+        auto velocity = dt > 0.f ? (position - replicated.lastPosition) / dt : sf::Vector2f();
+        replicated.lastPosition = position;
+
+        std::uint8_t animation = 0;
+        if (ent.hasComponent<xy::SpriteAnimation>())
+        {
+            const auto& anim = ent.getComponent<xy::SpriteAnimation>();
+            animation = static_cast<std::uint8_t>(anim.getAnimationIndex() & 0x7f);
+            if (!anim.stopped())
+                animation |= 0x80;
+        }
+
+        m_snapshot.entities.push_back(quantise(replicated.id, position, velocity, animation));
+    }
+
+    std::sort(m_snapshot.entities.begin(), m_snapshot.entities.end(),
+        [](const EntitySnapshot& a, const EntitySnapshot& b) { return a.id < b.id; });
+}
+
+//private
+void ReplicationSystem::onEntityAdded(xy::Entity ent)
+{
+    auto& replicated = ent.getComponent<Replicated>();
+    replicated.id = m_nextID++;
+    replicated.lastPosition = ent.getComponent<xy::Transform>().getPosition();
+}
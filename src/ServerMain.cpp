@@ -0,0 +1,261 @@
+#include <xyginext/core/MessageBus.hpp>
+
+#include <xyginext/ecs/components/Transform.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdlib>
+#include <memory>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "BotController.hpp"
+#include "FrameStats.hpp"
+#include "LaunchOptions.hpp"
+#include "Log.hpp"
+#include "NetDatagrams.hpp"
+#include "NetProtocol.hpp"
+#include "Prediction.hpp"
+#include "Profiler.hpp"
+#include "TerrainRenderer.hpp"
+#include "World.hpp"
+#include "WorldClient.hpp"
+#include "WorldServer.hpp"
+
+// Runs the world without a window, one fixed tick at a time
+// Takes the same options as the game, plus --ticks, --unthrottled and --bots, and serves the world on --port
+// With --clients it's a load test instead, joining the server at --connect as that many headless players
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    volatile std::sig_atomic_t interrupted = 0;
+
+    void onInterrupt(int)
+    {
+        interrupted = 1;
+    }
+
+    // Don't try to make up for ticks which overran, just start again from now
+    void waitForTick(Clock::time_point& nextTick, Clock::duration tick)
+    {
+        nextTick += tick;
+        auto now = Clock::now();
+        if (nextTick > now)
+            std::this_thread::sleep_until(nextTick);
+        else
+            nextTick = now;
+    }
+
+    // Headless clients walk to somewhere up to this far from the origin and wander about there, crossing chunks on the way
+    const float ClientSpread(3.f * ChunkSize * TileSize);
+
+    // Chunks past a client's subscriptions an entity may still be in, the server can have filed it
+    // against where the client was before its last crossing
+    const int ChunkSlack(1);
+
+    // A whole client, with its own world to mirror the server's into, and what it's found in the snapshots
+    struct HeadlessClient
+    {
+        explicit HeadlessClient(const LinkConditions& conditions) : client(conditions) {}
+
+        xy::MessageBus messageBus;
+        WorldClient client;
+        std::unique_ptr<World> world;
+
+        std::size_t entities = 0; // Summed over every snapshot
+        std::size_t unsorted = 0;
+        std::size_t missingAvatar = 0;
+        std::size_t outOfRange = 0;
+    };
+
+    // Checks a decoded snapshot holds what the server promises, sorted unique ids,
+    // the client's avatar, and only entities in chunks the client has loaded
+    void checkSnapshot(HeadlessClient& c, const Snapshot& snapshot, std::uint32_t avatarID)
+    {
+        auto camera = c.world->getScene().getActiveCamera();
+        auto focus = chunkAt(camera.getComponent<xy::Transform>().getWorldTransform().transformPoint({}));
+
+        bool sorted = true;
+        bool hasAvatar = false;
+        for (std::size_t i(0); i < snapshot.entities.size(); i++)
+        {
+            const auto& state = snapshot.entities[i];
+            if (i > 0 && state.id <= snapshot.entities[i - 1].id)
+                sorted = false;
+
+            hasAvatar |= state.id == avatarID;
+
+            auto offset = state.chunk - focus;
+            if (std::max(std::abs(offset.x), std::abs(offset.y)) > StreamRadius + ChunkSlack)
+                c.outOfRange++;
+        }
+
+        c.entities += snapshot.entities.size();
+        if (!sorted)
+            c.unsorted++;
+        if (!hasAvatar)
+            c.missingAvatar++;
+    }
+
+    void runClients(const LaunchOptions& options)
+    {
+        auto address = options.connectAddress.empty() ? std::string("127.0.0.1") : options.connectAddress;
+        auto port = options.port ? options.port : DefaultPort;
+
+        std::mt19937 random(static_cast<std::mt19937::result_type>(options.seed));
+        std::uniform_real_distribution<float> spread(-ClientSpread, ClientSpread);
+
+        std::vector<std::unique_ptr<HeadlessClient>> clients;
+        for (int i(0); i < options.clients; i++)
+        {
+            auto c = std::make_unique<HeadlessClient>(getSimulatedConditions());
+            if (!c->client.join(address, port))
+                break;
+
+            c->world = std::make_unique<World>(c->messageBus, true, &c->client.getParams());
+            // Predicted as WorldState's player is, so its input is recorded and sent to move its avatar on the server
+            auto player = c->world->getPlayer();
+            player.addComponent<Bot>().home = { spread(random), spread(random) };
+            player.addComponent<Predicted>();
+
+            auto& checked = *c;
+            c->client.setSnapshotCallback([&checked](const Snapshot& snapshot, std::uint32_t avatarID)
+            {
+                checkSnapshot(checked, snapshot, avatarID);
+            });
+            clients.push_back(std::move(c));
+        }
+
+        if (clients.empty())
+            return;
+
+        auto timestep = clients.front()->world->getTimestep();
+        auto tick = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<float>(timestep));
+        auto nextTick = Clock::now();
+        int ticks = 0;
+        FrameStats tickStats;
+
+        LOG_INFO("{} clients joined {}:{}", clients.size(), address, port);
+
+        auto connected = [&]()
+        {
+            return std::any_of(clients.begin(), clients.end(), [](const std::unique_ptr<HeadlessClient>& c) { return c->client.isConnected(); });
+        };
+
+        while (!interrupted && connected() && (options.tickLimit == 0 || ticks < options.tickLimit))
+        {
+            auto start = Clock::now();
+            for (auto& c : clients)
+            {
+                while (!c->messageBus.empty())
+                {
+                    const auto& msg = c->messageBus.poll();
+                    c->world->handleMessage(msg);
+                    c->client.handleMessage(msg);
+                }
+
+                c->world->update(timestep);
+                c->client.update(*c->world);
+            }
+            tickStats.addFrame(std::chrono::duration<float>(Clock::now() - start).count());
+            ticks++;
+
+            if (!options.unthrottled)
+                waitForTick(nextTick, tick);
+        }
+
+        LOG_INFO("Clients stopped after {} ticks", ticks);
+        tickStats.logSummary("client ticks");
+
+        std::size_t bytes = 0;
+        std::size_t problems = 0;
+        for (std::size_t i(0); i < clients.size(); i++)
+        {
+            const auto& c = *clients[i];
+            auto received = c.client.getSnapshotsReceived();
+            bytes += c.client.getSnapshotBytes();
+            problems += c.unsorted + c.missingAvatar + c.outOfRange;
+            if (received == 0)
+            {
+                LOG_WARNING("Client {} received no snapshots", i);
+                continue;
+            }
+
+            LOG_INFO("Client {}: {} snapshots, {} relevant entities, {} bytes per snapshot, {} bytes in all", i, received,
+                static_cast<float>(c.entities) / received, static_cast<float>(c.client.getSnapshotBytes()) / received, c.client.getSnapshotBytes());
+            if (c.unsorted || c.missingAvatar || c.outOfRange)
+            {
+                LOG_WARNING("Client {}: {} snapshots unsorted, {} without its avatar, {} entities outside its chunks",
+                    i, c.unsorted, c.missingAvatar, c.outOfRange);
+            }
+        }
+        LOG_INFO("{} clients received {} bytes of snapshots, {} problems found", clients.size(), bytes, problems);
+    }
+}
+
+int main(int argc, char** argv)
+{
+    Log::start();
+    parseLaunchOptions(argc, argv);
+    const auto& options = getLaunchOptions();
+
+    std::signal(SIGINT, onInterrupt);
+    std::signal(SIGTERM, onInterrupt);
+    PROFILE_THREAD_NAME("Server");
+
+    if (options.clients > 0)
+    {
+        runClients(options);
+    }
+    else
+    {
+        xy::MessageBus messageBus;
+        World world(messageBus, true);
+        world.spawnBots(options.bots);
+        FrameStats tickStats;
+
+        // Always listens, on the default port unless --port picks another
+        // With no clients connected the tick stats are a benchmark of the world on its own
+        WorldServer server(world, getSimulatedConditions());
+        server.listen(options.port ? options.port : DefaultPort);
+
+        auto tick = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<float>(world.getTimestep()));
+        auto nextTick = Clock::now();
+        int ticks = 0;
+
+        LOG_INFO("Server running at {} ticks per second", 1.f / world.getTimestep());
+
+        while (world.isRunning() && !interrupted && (options.tickLimit == 0 || ticks < options.tickLimit))
+        {
+            // Messages posted last tick, as xy::App would deliver them
+            while (!messageBus.empty())
+            {
+                world.handleMessage(messageBus.poll());
+            }
+
+            auto start = Clock::now();
+            server.update();
+            world.update(world.getTimestep());
+            tickStats.addFrame(std::chrono::duration<float>(Clock::now() - start).count());
+            ticks++;
+
+            if (!options.unthrottled)
+                waitForTick(nextTick, tick);
+        }
+
+        LOG_INFO("Server stopped after {} ticks", ticks);
+        tickStats.logSummary("ticks");
+    }
+
+#ifdef ENABLE_PROFILER
+    Profiler::writeTrace("server_profile.json");
+#endif
+
+    Log::stop();
+    return 0;
+}
@@ -0,0 +1,317 @@
+#include "Snapshot.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    const float ChunkWorldSize(ChunkSize * TileSize);
+
+    std::int16_t quantiseVelocity(float velocity)
+    {
+        return static_cast<std::int16_t>(std::min(std::max(std::round(velocity * VelocityScale), -32768.f), 32767.f));
+    }
+
+    std::size_t varBits(std::uint32_t value)
+    {
+        return 2 + (value < (1u << 4) ? 4 : value < (1u << 8) ? 8 : value < (1u << 16) ? 16 : 32);
+    }
+
+    std::size_t signedBits(std::int32_t value)
+    {
+        return varBits((static_cast<std::uint32_t>(value) << 1) ^ static_cast<std::uint32_t>(value >> 31));
+    }
+
+    // Each entry starts with a continuation bit and the gap since the previous entry's id
+    void writeID(BitWriter& writer, std::uint32_t id, std::uint32_t& lastID)
+    {
+        writer.writeBool(true);
+        writer.writeVar(id - lastID);
+        lastID = id;
+    }
+
+    void writeFull(BitWriter& writer, const EntitySnapshot& e)
+    {
+        writer.writeSigned(e.chunk.x);
+        writer.writeSigned(e.chunk.y);
+        writer.write(e.x, 16);
+        writer.write(e.y, 16);
+        writer.writeSigned(e.velocityX);
+        writer.writeSigned(e.velocityY);
+        writer.write(e.animation, 8);
+    }
+
+    void readFull(BitReader& reader, EntitySnapshot& e)
+    {
+        e.chunk.x = reader.readSigned();
+        e.chunk.y = reader.readSigned();
+        e.x = static_cast<std::uint16_t>(reader.read(16));
+        e.y = static_cast<std::uint16_t>(reader.read(16));
+        e.velocityX = static_cast<std::int16_t>(reader.readSigned());
+        e.velocityY = static_cast<std::int16_t>(reader.readSigned());
+        e.animation = static_cast<std::uint8_t>(reader.read(8));
+    }
+
+    // A bit per field group, then only the groups which changed
+    // Positions are a delta within the chunk, or in full when the entity has crossed into another
+    void writeDelta(BitWriter& writer, const EntitySnapshot& e, const EntitySnapshot& base)
+    {
+        bool chunkChanged = e.chunk != base.chunk;
+        bool positionChanged = chunkChanged || e.x != base.x || e.y != base.y;
+        bool velocityChanged = e.velocityX != base.velocityX || e.velocityY != base.velocityY;
+        bool animationChanged = e.animation != base.animation;
+
+        writer.writeBool(chunkChanged);
+        writer.writeBool(positionChanged);
+        writer.writeBool(velocityChanged);
+        writer.writeBool(animationChanged);
+
+        if (chunkChanged)
+        {
+            writer.writeSigned(e.chunk.x - base.chunk.x);
+            writer.writeSigned(e.chunk.y - base.chunk.y);
+            writer.write(e.x, 16);
+            writer.write(e.y, 16);
+        }
+        else if (positionChanged)
+        {
+            writer.writeSigned(e.x - base.x);
+            writer.writeSigned(e.y - base.y);
+        }
+
+        if (velocityChanged)
+        {
+            writer.writeSigned(e.velocityX - base.velocityX);
+            writer.writeSigned(e.velocityY - base.velocityY);
+        }
+
+        if (animationChanged)
+            writer.write(e.animation, 8);
+    }
+
+    void readDelta(BitReader& reader, EntitySnapshot& e)
+    {
+        bool chunkChanged = reader.readBool();
+        bool positionChanged = reader.readBool();
+        bool velocityChanged = reader.readBool();
+        bool animationChanged = reader.readBool();
+
+        if (chunkChanged)
+        {
+            e.chunk.x += reader.readSigned();
+            e.chunk.y += reader.readSigned();
+            e.x = static_cast<std::uint16_t>(reader.read(16));
+            e.y = static_cast<std::uint16_t>(reader.read(16));
+        }
+        else if (positionChanged)
+        {
+            e.x = static_cast<std::uint16_t>(e.x + reader.readSigned());
+            e.y = static_cast<std::uint16_t>(e.y + reader.readSigned());
+        }
+
+        if (velocityChanged)
+        {
+            e.velocityX = static_cast<std::int16_t>(e.velocityX + reader.readSigned());
+            e.velocityY = static_cast<std::int16_t>(e.velocityY + reader.readSigned());
+        }
+
+        if (animationChanged)
+            e.animation = static_cast<std::uint8_t>(reader.read(8));
+    }
+}
+
+bool sameState(const EntitySnapshot& a, const EntitySnapshot& b)
+{
+    return a.chunk == b.chunk && a.x == b.x && a.y == b.y
+        && a.velocityX == b.velocityX && a.velocityY == b.velocityY && a.animation == b.animation;
+}
+
+std::size_t measureEntity(const EntitySnapshot& e, const EntitySnapshot* base)
+{
+    // Mirrors writeFull() and writeDelta()
+    if (!base)
+    {
+        return signedBits(e.chunk.x) + signedBits(e.chunk.y) + 32
+            + signedBits(e.velocityX) + signedBits(e.velocityY) + 8;
+    }
+
+    std::size_t bits = 1 + 4; // Removed flag and the change mask
+    if (e.chunk != base->chunk)
+        bits += signedBits(e.chunk.x - base->chunk.x) + signedBits(e.chunk.y - base->chunk.y) + 32;
+    else if (e.x != base->x || e.y != base->y)
+        bits += signedBits(e.x - base->x) + signedBits(e.y - base->y);
+
+    if (e.velocityX != base->velocityX || e.velocityY != base->velocityY)
+        bits += signedBits(e.velocityX - base->velocityX) + signedBits(e.velocityY - base->velocityY);
+
+    if (e.animation != base->animation)
+        bits += 8;
+
+    return bits;
+}
+
+void writePosition(BitWriter& writer, sf::Vector2f position)
+{
+    auto e = quantise(0, position, {}, 0);
+    writer.writeSigned(e.chunk.x);
+    writer.writeSigned(e.chunk.y);
+    writer.write(e.x, 16);
+    writer.write(e.y, 16);
+}
+
+sf::Vector2f readPosition(BitReader& reader)
+{
+    EntitySnapshot e;
+    e.chunk.x = reader.readSigned();
+    e.chunk.y = reader.readSigned();
+    e.x = static_cast<std::uint16_t>(reader.read(16));
+    e.y = static_cast<std::uint16_t>(reader.read(16));
+    return getPosition(e);
+}
+
+EntitySnapshot quantise(std::uint32_t id, sf::Vector2f position, sf::Vector2f velocity, std::uint8_t animation)
+{
+    EntitySnapshot e;
+    e.id = id;
+    e.chunk = chunkAt(position);
+
+    auto quantisePosition = [](float world, int chunk)
+    {
+        float local = (world - chunk * ChunkWorldSize) * PositionScale;
+        return static_cast<std::uint16_t>(std::min(std::max(std::round(local), 0.f), 65535.f));
+    };
+    e.x = quantisePosition(position.x, e.chunk.x);
+    e.y = quantisePosition(position.y, e.chunk.y);
+
+    e.velocityX = quantiseVelocity(velocity.x);
+    e.velocityY = quantiseVelocity(velocity.y);
+    e.animation = animation;
+    return e;
+}
+
+sf::Vector2f getPosition(const EntitySnapshot& e)
+{
+    return { e.chunk.x * ChunkWorldSize + e.x / PositionScale, e.chunk.y * ChunkWorldSize + e.y / PositionScale };
+}
+
+sf::Vector2f getVelocity(const EntitySnapshot& e)
+{
+    return { e.velocityX / VelocityScale, e.velocityY / VelocityScale };
+}
+
+std::size_t writeSnapshot(BitWriter& writer, const Snapshot& current, const Snapshot& baseline, std::size_t maxBytes, Snapshot& visible)
+{
+    visible.sequence = current.sequence;
+    visible.entities.clear();
+
+    std::size_t skipped = 0;
+    std::uint32_t lastID = 0;
+
+    // Each entry is written then taken back out again if it went over, a later smaller one may still fit
+    auto fits = [&](std::size_t mark, std::uint32_t markID)
+    {
+        // Leaving room for the terminating bit
+        if ((writer.getBitCount() + 8) / 8 <= maxBytes)
+            return true;
+
+        writer.rewind(mark);
+        lastID = markID;
+        skipped++;
+        return false;
+    };
+
+    // Both are sorted by id, so walk them together
+    auto c = current.entities.begin();
+    auto b = baseline.entities.begin();
+    while (c != current.entities.end() || b != baseline.entities.end())
+    {
+        auto mark = writer.getBitCount();
+        auto markID = lastID;
+
+        if (b == baseline.entities.end() || (c != current.entities.end() && c->id < b->id))
+        {
+            // New since the baseline
+            writeID(writer, c->id, lastID);
+            writeFull(writer, *c);
+            if (fits(mark, markID))
+                visible.entities.push_back(*c);
+            ++c;
+        }
+        else if (c == current.entities.end() || b->id < c->id)
+        {
+            // Gone since the baseline
+            writeID(writer, b->id, lastID);
+            writer.writeBool(true);
+            if (!fits(mark, markID))
+                visible.entities.push_back(*b);
+            ++b;
+        }
+        else
+        {
+            if (!sameState(*c, *b))
+            {
+                writeID(writer, c->id, lastID);
+                writer.writeBool(false);
+                writeDelta(writer, *c, *b);
+                visible.entities.push_back(fits(mark, markID) ? *c : *b);
+            }
+            else
+            {
+                visible.entities.push_back(*c);
+            }
+            ++c;
+            ++b;
+        }
+    }
+
+    writer.writeBool(false);
+    return skipped;
+}
+
+bool readSnapshot(BitReader& reader, const Snapshot& baseline, Snapshot& out)
+{
+    out.entities.clear();
+
+    std::uint32_t lastID = 0;
+    auto b = baseline.entities.begin();
+    while (reader.readBool())
+    {
+        auto gap = reader.readVar();
+        if (gap == 0)
+            return false;
+
+        auto id = lastID + gap;
+        lastID = id;
+
+        // Baseline entities up to this one are unchanged
+        while (b != baseline.entities.end() && b->id < id)
+        {
+            out.entities.push_back(*b++);
+        }
+
+        if (b != baseline.entities.end() && b->id == id)
+        {
+            bool removed = reader.readBool();
+            if (!removed)
+            {
+                auto e = *b;
+                readDelta(reader, e);
+                out.entities.push_back(e);
+            }
+            ++b;
+        }
+        else
+        {
+            EntitySnapshot e;
+            e.id = id;
+            readFull(reader, e);
+            out.entities.push_back(e);
+        }
+
+        if (!reader.isValid())
+            return false;
+    }
+
+    out.entities.insert(out.entities.end(), b, baseline.entities.end());
+    return reader.isValid();
+}
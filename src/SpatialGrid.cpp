@@ -0,0 +1,238 @@
+#include "SpatialGrid.hpp"
+
+#include <xyginext/ecs/components/Transform.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+#include "Collider.hpp"
+#include "Profiler.hpp"
+
+namespace
+{
+    sf::Vector2i cellAt(sf::Vector2f position)
+    {
+        return { static_cast<int>(std::floor(position.x / GridCellSize)), static_cast<int>(std::floor(position.y / GridCellSize)) };
+    }
+
+    sf::Vector2i chunkOf(sf::Vector2i cell)
+    {
+        return { floorDiv(cell.x, GridCellsPerChunk), floorDiv(cell.y, GridCellsPerChunk) };
+    }
+
+    std::size_t cellSlot(sf::Vector2i cell, sf::Vector2i chunk)
+    {
+        return (cell.y - chunk.y * GridCellsPerChunk) * GridCellsPerChunk + (cell.x - chunk.x * GridCellsPerChunk);
+    }
+
+    sf::Vector2f centreOf(const sf::FloatRect& bounds)
+    {
+        return { bounds.left + bounds.width / 2.f, bounds.top + bounds.height / 2.f };
+    }
+
+    bool overlaps(const sf::FloatRect& a, const sf::FloatRect& b)
+    {
+        return a.left < b.left + b.width && b.left < a.left + a.width
+            && a.top < b.top + b.height && b.top < a.top + a.height;
+    }
+
+    bool overlaps(const sf::FloatRect& box, sf::Vector2f centre, float radius)
+    {
+        float x = std::min(std::max(centre.x, box.left), box.left + box.width) - centre.x;
+        float y = std::min(std::max(centre.y, box.top), box.top + box.height) - centre.y;
+        return x * x + y * y < radius * radius;
+    }
+}
+
+SpatialGrid::SpatialGrid(xy::MessageBus& mb) :
+    xy::System(mb, typeid(SpatialGrid))
+{
+    requireComponent<Collider>();
+    requireComponent<xy::Transform>();
+}
+
+void SpatialGrid::process(float)
+{
+    PROFILE_SCOPE("SpatialGrid::process");
+
+    for (auto& ent : getEntities())
+    {
+        auto bounds = getBounds(ent);
+        fitHalfSize(bounds);
+
+        auto cell = cellAt(centreOf(bounds));
+        auto& location = m_locations[ent.getIndex()];
+
+        if (cell != location.cell)
+        {
+            remove(location);
+            insert({ ent, bounds }, cell);
+        }
+        else
+        {
+            location.chunk->cells[cellSlot(cell, chunkOf(cell))][location.slot].bounds = bounds;
+        }
+    }
+}
+
+std::size_t SpatialGrid::queryArea(const sf::FloatRect& area, std::vector<xy::Entity>& out) const
+{
+    return query(area, out, [&](const sf::FloatRect& bounds) { return overlaps(area, bounds); });
+}
+
+std::size_t SpatialGrid::queryRadius(sf::Vector2f centre, float radius, std::vector<xy::Entity>& out) const
+{
+    sf::FloatRect area(centre.x - radius, centre.y - radius, radius * 2.f, radius * 2.f);
+    return query(area, out, [&](const sf::FloatRect& bounds) { return overlaps(bounds, centre, radius); });
+}
+
+void SpatialGrid::queryAreas(const std::vector<sf::FloatRect>& areas, std::vector<xy::Entity>& out, std::vector<std::size_t>& offsets) const
+{
+    offsets.clear();
+    offsets.push_back(out.size());
+    for (const auto& area : areas)
+    {
+        queryArea(area, out);
+        offsets.push_back(out.size());
+    }
+}
+
+void SpatialGrid::queryRadii(const std::vector<sf::Vector2f>& centres, float radius, std::vector<xy::Entity>& out, std::vector<std::size_t>& offsets) const
+{
+    offsets.clear();
+    offsets.push_back(out.size());
+    for (auto centre : centres)
+    {
+        queryRadius(centre, radius, out);
+        offsets.push_back(out.size());
+    }
+}
+
+std::size_t SpatialGrid::getChunkEntities(sf::Vector2i chunk, std::vector<xy::Entity>& out) const
+{
+    auto result = m_chunks.find(chunkKey(chunk));
+    if (result == m_chunks.end())
+        return 0;
+
+    for (const auto& cell : result->second.cells)
+    {
+        for (const auto& item : cell)
+            out.push_back(item.entity);
+    }
+    return result->second.count;
+}
+
+sf::Vector2i SpatialGrid::getChunk(xy::Entity ent)
+{
+    return chunkOf(cellAt(centreOf(getBounds(ent))));
+}
+
+//private
+void SpatialGrid::onEntityAdded(xy::Entity ent)
+{
+    if (ent.getIndex() >= m_locations.size())
+        m_locations.resize(ent.getIndex() + 1);
+
+    auto bounds = getBounds(ent);
+    fitHalfSize(bounds);
+    insert({ ent, bounds }, cellAt(centreOf(bounds)));
+}
+
+void SpatialGrid::onEntityRemoved(xy::Entity ent)
+{
+    if (ent.getIndex() < m_locations.size())
+        remove(m_locations[ent.getIndex()]);
+}
+
+void SpatialGrid::fitHalfSize(const sf::FloatRect& bounds)
+{
+    m_maxHalfSize.x = std::max(m_maxHalfSize.x, bounds.width / 2.f);
+    m_maxHalfSize.y = std::max(m_maxHalfSize.y, bounds.height / 2.f);
+}
+
+sf::FloatRect SpatialGrid::getBounds(xy::Entity ent)
+{
+    auto bounds = ent.getComponent<Collider>().bounds;
+    auto position = ent.getComponent<xy::Transform>().getPosition();
+    bounds.left += position.x;
+    bounds.top += position.y;
+    return bounds;
+}
+
+void SpatialGrid::insert(const Item& item, sf::Vector2i cell)
+{
+    auto chunk = chunkOf(cell);
+    auto& chunkCells = m_chunks[chunkKey(chunk)];
+    auto& bucket = chunkCells.cells[cellSlot(cell, chunk)];
+
+    auto& location = m_locations[item.entity.getIndex()];
+    location.chunk = &chunkCells;
+    location.cell = cell;
+    location.slot = bucket.size();
+
+    bucket.push_back(item);
+    chunkCells.count++;
+}
+
+void SpatialGrid::remove(Location& location)
+{
+    auto* chunkCells = location.chunk;
+    if (!chunkCells)
+        return;
+    location.chunk = nullptr;
+
+    // Swap the last item into the gap and tell it where it went
+    auto chunk = chunkOf(location.cell);
+    auto& bucket = chunkCells->cells[cellSlot(location.cell, chunk)];
+    auto slot = location.slot;
+    if (slot != bucket.size() - 1)
+    {
+        bucket[slot] = bucket.back();
+        m_locations[bucket[slot].entity.getIndex()].slot = slot;
+    }
+    bucket.pop_back();
+
+    if (--chunkCells->count == 0)
+        m_chunks.erase(chunkKey(chunk));
+}
+
+template<typename Test>
+std::size_t SpatialGrid::query(const sf::FloatRect& area, std::vector<xy::Entity>& out, Test&& test) const
+{
+    auto first = cellAt({ area.left - m_maxHalfSize.x, area.top - m_maxHalfSize.y });
+    auto last = cellAt({ area.left + area.width + m_maxHalfSize.x, area.top + area.height + m_maxHalfSize.y });
+
+    std::size_t count = 0;
+    for (int y = first.y; y <= last.y; y++)
+    {
+        const ChunkCells* chunkCells = nullptr;
+        sf::Vector2i currentChunk(first.x - 1, y);
+        bool looked = false;
+
+        for (int x = first.x; x <= last.x; x++)
+        {
+            sf::Vector2i cell(x, y);
+            auto chunk = chunkOf(cell);
+            if (!looked || chunk != currentChunk)
+            {
+                auto result = m_chunks.find(chunkKey(chunk));
+                chunkCells = result != m_chunks.end() ? &result->second : nullptr;
+                currentChunk = chunk;
+                looked = true;
+            }
+
+            if (!chunkCells)
+                continue;
+
+            for (const auto& item : chunkCells->cells[cellSlot(cell, chunk)])
+            {
+                if (test(item.bounds))
+                {
+                    out.push_back(item.entity);
+                    count++;
+                }
+            }
+        }
+    }
+    return count;
+}
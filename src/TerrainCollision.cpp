@@ -0,0 +1,194 @@
+#include "TerrainCollision.hpp"
+
+#include <xyginext/ecs/Scene.hpp>
+#include <xyginext/ecs/components/Transform.hpp>
+
+#include <cmath>
+
+#include "Collider.hpp"
+#include "Physics.hpp"
+#include "Profiler.hpp"
+#include "TerrainChunk.hpp"
+#include "TerrainRenderer.hpp"
+#include "Velocity.hpp"
+
+namespace
+{
+    // Tile lookups for one sweep, remembering the last chunk since neighbouring tiles nearly always share it
+    class SeaQuery final
+    {
+    public:
+        explicit SeaQuery(const TerrainRenderer& terrain) : m_terrain(terrain) {}
+
+        bool isSea(int tileX, int tileY)
+        {
+            sf::Vector2i index(floorDiv(tileX, ChunkSize), floorDiv(tileY, ChunkSize));
+            if (!m_hasChunk || index != m_index)
+            {
+                m_chunk = m_terrain.getChunk(index);
+                m_index = index;
+                m_hasChunk = true;
+            }
+
+            return m_chunk && !m_chunk->isLand(tileX - index.x * ChunkSize, tileY - index.y * ChunkSize);
+        }
+
+        // Tiles [first, last] along the other axis at the given line
+        bool anySeaInColumn(int tileX, int firstY, int lastY)
+        {
+            for (int y = firstY; y <= lastY; y++)
+            {
+                if (isSea(tileX, y))
+                    return true;
+            }
+            return false;
+        }
+
+        bool anySeaInRow(int tileY, int firstX, int lastX)
+        {
+            for (int x = firstX; x <= lastX; x++)
+            {
+                if (isSea(x, tileY))
+                    return true;
+            }
+            return false;
+        }
+
+    private:
+        const TerrainRenderer& m_terrain;
+        const TerrainChunk* m_chunk = nullptr;
+        sf::Vector2i m_index;
+        bool m_hasChunk = false;
+    };
+
+    // Boxes are half open, [min, max), so a box edge resting on a tile edge doesn't touch that tile
+    int firstTile(float min) { return static_cast<int>(std::floor(min / TileSize)); }
+    int lastTile(float max) { return static_cast<int>(std::ceil(max / TileSize)) - 1; }
+
+    // Sweeps the box's leading edge along one axis from start to start + delta
+    // Returns the allowed delta, and whether it was cut short
+    template<typename LineTest>
+    float sweep(float min, float max, float delta, LineTest&& lineHasSea, bool& blocked)
+    {
+        blocked = false;
+        if (delta > 0.f)
+        {
+            int from = lastTile(max) + 1;
+            int to = lastTile(max + delta);
+            for (int t = from; t <= to; t++)
+            {
+                if (lineHasSea(t))
+                {
+                    blocked = true;
+                    return t * TileSize - max;
+                }
+            }
+        }
+        else if (delta < 0.f)
+        {
+            int from = firstTile(min) - 1;
+            int to = firstTile(min + delta);
+            for (int t = from; t >= to; t--)
+            {
+                if (lineHasSea(t))
+                {
+                    blocked = true;
+                    return (t + 1) * TileSize - min;
+                }
+            }
+        }
+        return delta;
+    }
+
+    // Moves the box on each axis in turn, stopping at the first sea tile
+    sf::Vector2f sweepBox(SeaQuery& query, sf::Vector2f from, sf::Vector2f to, const sf::FloatRect& bounds, bool& blockedX, bool& blockedY)
+    {
+        auto delta = to - from;
+        auto pos = from;
+
+        // X first, over the rows the box covers now
+        int firstY = firstTile(pos.y + bounds.top);
+        int lastY = lastTile(pos.y + bounds.top + bounds.height);
+        pos.x += sweep(pos.x + bounds.left, pos.x + bounds.left + bounds.width, delta.x,
+            [&](int column) { return query.anySeaInColumn(column, firstY, lastY); }, blockedX);
+
+        // Then Y, over the columns it covers after moving
+        int firstX = firstTile(pos.x + bounds.left);
+        int lastX = lastTile(pos.x + bounds.left + bounds.width);
+        pos.y += sweep(pos.y + bounds.top, pos.y + bounds.top + bounds.height, delta.y,
+            [&](int row) { return query.anySeaInRow(row, firstX, lastX); }, blockedY);
+
+        return pos;
+    }
+}
+
+TerrainCollision::TerrainCollision(xy::MessageBus& mb) :
+    xy::System(mb, typeid(TerrainCollision))
+{
+    requireComponent<Collider>();
+    requireComponent<xy::Transform>();
+}
+
+void TerrainCollision::process(float)
+{
+    PROFILE_SCOPE("TerrainCollision::process");
+
+    SeaQuery query(getScene()->getSystem<TerrainRenderer>());
+    for (auto& ent : getEntities())
+    {
+        auto& t = ent.getComponent<xy::Transform>();
+        auto& resolved = m_resolved[ent.getIndex()];
+        auto target = t.getPosition();
+
+        if (target == resolved)
+            continue;
+
+        bool blockedX, blockedY;
+        auto pos = sweepBox(query, resolved, target, ent.getComponent<Collider>().bounds, blockedX, blockedY);
+
+        resolved = pos;
+        if (blockedX || blockedY)
+        {
+            t.setPosition(pos);
+
+            // Physics keeps its own positions, so tell it too and stop it pushing into the shore
+            if (ent.hasComponent<Velocity>())
+            {
+                auto& physics = getScene()->getSystem<Physics>();
+                auto velocity = physics.getVelocity(ent);
+                if (blockedX)
+                    velocity.x = 0.f;
+                if (blockedY)
+                    velocity.y = 0.f;
+
+                physics.setPosition(ent, pos);
+                physics.setVelocity(ent, velocity);
+            }
+        }
+    }
+}
+
+sf::Vector2f TerrainCollision::resolve(sf::Vector2f from, sf::Vector2f to, const sf::FloatRect& bounds)
+{
+    SeaQuery query(getScene()->getSystem<TerrainRenderer>());
+    bool blockedX, blockedY;
+    return sweepBox(query, from, to, bounds, blockedX, blockedY);
+}
+
+void TerrainCollision::resetBody(xy::Entity ent)
+{
+    auto resolved = m_resolved.find(ent.getIndex());
+    if (resolved != m_resolved.end())
+        resolved->second = ent.getComponent<xy::Transform>().getPosition();
+}
+
+//private
+void TerrainCollision::onEntityAdded(xy::Entity ent)
+{
+    m_resolved[ent.getIndex()] = ent.getComponent<xy::Transform>().getPosition();
+}
+
+void TerrainCollision::onEntityRemoved(xy::Entity ent)
+{
+    m_resolved.erase(ent.getIndex());
+}
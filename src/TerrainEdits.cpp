@@ -0,0 +1,78 @@
+#include "TerrainEdits.hpp"
+
+#include <algorithm>
+
+namespace
+{
+    // Edited tiles get a height just either side of sea level, only which side matters to anything reading it
+    const float EditedLandHeight(SeaLevel + 0.01f);
+    const float EditedSeaHeight(SeaLevel - 0.01f);
+
+    const std::vector<TileEdit> NoEdits;
+
+    sf::Vector2i chunkOf(const TileEdit& edit)
+    {
+        return { floorDiv(edit.x, ChunkSize), floorDiv(edit.y, ChunkSize) };
+    }
+}
+
+sf::Vector2i TerrainEdits::add(const TileEdit& edit)
+{
+    auto index = chunkOf(edit);
+    auto& edits = m_chunks[chunkKey(index)];
+
+    auto existing = std::find_if(edits.begin(), edits.end(), [&](const TileEdit& e) { return e.x == edit.x && e.y == edit.y; });
+    if (existing != edits.end())
+    {
+        *existing = edit;
+    }
+    else
+    {
+        edits.push_back(edit);
+        m_count++;
+    }
+    return index;
+}
+
+const std::vector<TileEdit>& TerrainEdits::getChunkEdits(sf::Vector2i index) const
+{
+    auto result = m_chunks.find(chunkKey(index));
+    return result != m_chunks.end() ? result->second : NoEdits;
+}
+
+void TerrainEdits::applyTo(TerrainChunk& chunk) const
+{
+    for (const auto& edit : getChunkEdits(chunk.getIndex()))
+    {
+        apply(chunk, edit);
+    }
+}
+
+void TerrainEdits::apply(TerrainChunk& chunk, const TileEdit& edit)
+{
+    auto index = chunk.getIndex();
+    int i = (edit.y - index.y * ChunkSize) * ChunkSize + (edit.x - index.x * ChunkSize);
+    auto bit = std::uint64_t(1) << (i & 63);
+
+    // An edit replaces whatever a stamp put on the tile
+    chunk.stamped[i >> 6] &= ~bit;
+
+    if (edit.land)
+    {
+        chunk.land[i >> 6] |= bit;
+        if (chunk.height[i] <= SeaLevel)
+        {
+            chunk.height[i] = EditedLandHeight;
+            chunk.biome[i] = Biome::Beach;
+        }
+    }
+    else
+    {
+        chunk.land[i >> 6] &= ~bit;
+        if (chunk.height[i] > SeaLevel)
+        {
+            chunk.height[i] = EditedSeaHeight;
+            chunk.biome[i] = Biome::Ocean;
+        }
+    }
+}
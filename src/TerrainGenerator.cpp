@@ -0,0 +1,266 @@
+#include "TerrainGenerator.hpp"
+#include "Hash.hpp"
+#include "Profiler.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+namespace
+{
+    // Moisture and temperature share a frequency so they are generated in a single fused pass
+    const float ClimateFrequency(0.004f);
+
+    // Regions are cells a few dozen tiles across used to vary the land tiles
+    const float RegionFrequency(0.05f);
+
+    enum HeightBand
+    {
+        Sea,
+        Shore,
+        Land,
+        HeightBandCount
+    };
+
+    // Land just above sea level is treated as beach
+    const float ShoreHeight(SeaLevel + 0.05f);
+
+    int quantise(float value)
+    {
+        int step = static_cast<int>((value + 1.f) * 0.5f * BiomeSteps);
+        return std::min(std::max(step, 0), BiomeSteps - 1);
+    }
+}
+
+constexpr std::uint32_t TerrainGenerator::Version;
+
+TerrainGenerator::Params TerrainGenerator::defaultParams(int seed)
+{
+    auto describe = [](const TerrainNoise& noise)
+    {
+        NoiseParams p;
+        p.frequency = noise.GetFrequency();
+        p.octaves = noise.GetFractalOctaves();
+        p.lacunarity = noise.GetFractalLacunarity();
+        p.gain = noise.GetFractalGain();
+        p.cellularJitter = noise.GetCellularJitter();
+        p.noiseType = static_cast<std::uint8_t>(noise.GetNoiseType());
+        p.fractalType = static_cast<std::uint8_t>(noise.GetFractalType());
+        p.interp = static_cast<std::uint8_t>(noise.GetInterp());
+        p.cellularDistance = static_cast<std::uint8_t>(noise.GetCellularDistanceFunction());
+        p.cellularReturn = static_cast<std::uint8_t>(noise.GetCellularReturnType());
+        return p;
+    };
+
+    // Height keeps the FastNoise defaults so existing worlds are unchanged
+    TerrainNoise height;
+
+    TerrainNoise climate;
+    climate.SetFrequency(ClimateFrequency);
+
+    TerrainNoise region;
+    region.SetNoiseType(TerrainNoise::Cellular);
+    region.SetCellularReturnType(TerrainNoise::CellValue);
+    region.SetFrequency(RegionFrequency);
+
+    Params params;
+    params.seed = seed;
+    params.layers[Height] = describe(height);
+    params.layers[Moisture] = describe(climate);
+    params.layers[Temperature] = describe(climate);
+    params.layers[Region] = describe(region);
+    return params;
+}
+
+bool TerrainGenerator::isSane(const Params& params)
+{
+    for (const auto& p : params.layers)
+    {
+        if (p.octaves < 1 || p.octaves > FN_MAX_FUSED_OCTAVES)
+            return false;
+
+        if (!std::isfinite(p.frequency) || !std::isfinite(p.lacunarity) || !std::isfinite(p.gain) || !std::isfinite(p.cellularJitter))
+            return false;
+
+        if (p.noiseType > TerrainNoise::CubicFractal || p.fractalType > TerrainNoise::RigidMulti || p.interp > TerrainNoise::Quintic
+            || p.cellularDistance > TerrainNoise::Natural || p.cellularReturn > TerrainNoise::Distance2Div)
+            return false;
+    }
+    return true;
+}
+
+std::uint64_t TerrainGenerator::hashParams(const Params& params)
+{
+    // Field by field, the structs have padding
+    auto hash = fnv1aValue(Version);
+    hash = fnv1aValue(ChunkSize, hash);
+    hash = fnv1aValue(params.seed, hash);
+    for (const auto& p : params.layers)
+    {
+        hash = fnv1aValue(p.frequency, hash);
+        hash = fnv1aValue(p.octaves, hash);
+        hash = fnv1aValue(p.lacunarity, hash);
+        hash = fnv1aValue(p.gain, hash);
+        hash = fnv1aValue(p.cellularJitter, hash);
+        hash = fnv1aValue(p.noiseType, hash);
+        hash = fnv1aValue(p.fractalType, hash);
+        hash = fnv1aValue(p.interp, hash);
+        hash = fnv1aValue(p.cellularDistance, hash);
+        hash = fnv1aValue(p.cellularReturn, hash);
+    }
+    return hash;
+}
+
+std::uint64_t TerrainGenerator::hashChunk(const TerrainChunk& chunk)
+{
+    // The quantised layers rather than raw heights, so float noise differing in the last bit
+    // between compilers only counts when it actually changes a tile
+    auto hash = fnv1a(chunk.land.data(), chunk.land.size() * sizeof(std::uint64_t));
+    return fnv1a(chunk.biome.data(), chunk.biome.size() * sizeof(Biome), hash);
+}
+
+TerrainGenerator::TerrainGenerator(int seed) :
+    TerrainGenerator(defaultParams(seed))
+{
+
+}
+
+TerrainGenerator::TerrainGenerator(const Params& params) :
+    m_params(params)
+{
+    for (int i(0); i < LayerCount; i++)
+    {
+        const auto& p = params.layers[i];
+        auto& layer = m_layers[i];
+        layer.SetSeed(params.seed + i);
+        layer.SetFrequency(p.frequency);
+        layer.SetFractalOctaves(p.octaves);
+        layer.SetFractalLacunarity(p.lacunarity);
+        layer.SetFractalGain(p.gain);
+        layer.SetCellularJitter(p.cellularJitter);
+        layer.SetNoiseType(static_cast<TerrainNoise::NoiseType>(p.noiseType));
+        layer.SetFractalType(static_cast<TerrainNoise::FractalType>(p.fractalType));
+        layer.SetInterp(static_cast<TerrainNoise::Interp>(p.interp));
+        layer.SetCellularDistanceFunction(static_cast<TerrainNoise::CellularDistanceFunction>(p.cellularDistance));
+        layer.SetCellularReturnType(static_cast<TerrainNoise::CellularReturnType>(p.cellularReturn));
+    }
+
+    // Group every simplex layer with the first layer it can share lattice work with
+    for (int i(0); i < LayerCount; i++)
+    {
+        auto layer = static_cast<Layer>(i);
+        if (m_layers[layer].GetNoiseType() == TerrainNoise::Cellular)
+            continue;
+
+        auto group = std::find_if(m_fusedGroups.begin(), m_fusedGroups.end(), [&](const std::vector<Layer>& g)
+        {
+            return g.size() < FN_MAX_FUSED_LAYERS && TerrainNoise::CanFuseLayers(m_layers[g.front()], m_layers[layer]);
+        });
+
+        if (group != m_fusedGroups.end())
+            group->push_back(layer);
+        else
+            m_fusedGroups.push_back({ layer });
+    }
+
+    buildBiomeTable();
+}
+
+void TerrainGenerator::generate(TerrainChunk& chunk, sf::Vector2i index) const
+{
+    PROFILE_SCOPE("TerrainGenerator::generate");
+
+    chunk.setIndex(index);
+    chunk.allocate();
+    std::fill(chunk.land.begin(), chunk.land.end(), 0);
+    std::fill(chunk.stamped.begin(), chunk.stamped.end(), 0);
+
+    std::array<float*, LayerCount> outputs{ chunk.height.data(), chunk.moisture.data(), chunk.temperature.data(), chunk.region.data() };
+
+    for (const auto& group : m_fusedGroups)
+    {
+        std::array<const TerrainNoise*, FN_MAX_FUSED_LAYERS> layers;
+        std::array<float*, FN_MAX_FUSED_LAYERS> out;
+        for (std::size_t i(0); i < group.size(); i++)
+        {
+            layers[i] = &m_layers[group[i]];
+            out[i] = outputs[group[i]];
+        }
+
+        TerrainNoise::FillSimplexFractalLayers(layers.data(), static_cast<int>(group.size()),
+            index.x * ChunkSize, index.y * ChunkSize, 0, 0, ChunkSize, ChunkSize, out.data());
+    }
+
+    // Cellular regions reuse each cell's feature point across the whole chunk
+    // Chunks are generated on several threads, each keeps its own scratch so streaming doesn't allocate
+    static thread_local TerrainNoise::CellularGridScratch scratch;
+    m_layers[Region].GetCellularGrid(outputs[Region], index.x * ChunkSize, index.y * ChunkSize, 0.f, 0.f, ChunkSize, ChunkSize, scratch);
+
+    // Classify biomes with a single table lookup per tile
+    for (int i(0); i < TileCount; i++)
+    {
+        int band = chunk.height[i] > ShoreHeight ? Land : chunk.height[i] > SeaLevel ? Shore : Sea;
+        int lookup = (band * BiomeSteps + quantise(chunk.moisture[i])) * BiomeSteps + quantise(chunk.temperature[i]);
+        chunk.biome[i] = m_biomeTable[lookup];
+
+        if (chunk.height[i] > SeaLevel)
+            chunk.land[i >> 6] |= std::uint64_t(1) << (i & 63);
+    }
+
+    chunk.contentHash = hashChunk(chunk);
+}
+
+int TerrainGenerator::getVariant(int tileX, int tileY, int count) const
+{
+    // Same integer hash FastNoise uses for its lattice, seeded by the height layer
+    std::uint32_t hash = static_cast<std::uint32_t>(m_layers[Height].GetSeed());
+    hash ^= 1619u * static_cast<std::uint32_t>(tileX);
+    hash ^= 31337u * static_cast<std::uint32_t>(tileY);
+    hash = hash * hash * hash * 60493u;
+    hash = (hash >> 13) ^ hash;
+
+    return static_cast<int>(hash % static_cast<std::uint32_t>(count));
+}
+
+float TerrainGenerator::getHeight(int tileX, int tileY) const
+{
+    // Round towards negative infinity so negative tiles find the same chunk origin as generate()
+    auto chunkOrigin = [](int tile) { return (tile >= 0 ? tile : tile - ChunkSize + 1) / ChunkSize * ChunkSize; };
+    int originX = chunkOrigin(tileX);
+    int originY = chunkOrigin(tileY);
+
+    float height;
+    float* out = &height;
+    const TerrainNoise* layer = &m_layers[Height];
+    TerrainNoise::FillSimplexFractalLayers(&layer, 1, originX, originY, tileX - originX, tileY - originY, 1, 1, &out);
+    return height;
+}
+
+//private
+void TerrainGenerator::buildBiomeTable()
+{
+    for (int band(0); band < HeightBandCount; band++)
+    {
+        for (int moisture(0); moisture < BiomeSteps; moisture++)
+        {
+            for (int temperature(0); temperature < BiomeSteps; temperature++)
+            {
+                Biome biome;
+                if (band == Sea)
+                    biome = Biome::Ocean;
+                else if (band == Shore)
+                    biome = temperature < 2 ? Biome::Tundra : Biome::Beach;
+                else if (temperature < 2)
+                    biome = moisture < 4 ? Biome::Tundra : Biome::Snow;
+                else if (temperature < 4)
+                    biome = moisture < 3 ? Biome::Grassland : Biome::Taiga;
+                else if (temperature < 6)
+                    biome = moisture < 2 ? Biome::Grassland : Biome::Forest;
+                else
+                    biome = moisture < 3 ? Biome::Desert : moisture < 5 ? Biome::Grassland : Biome::Rainforest;
+
+                m_biomeTable[(band * BiomeSteps + moisture) * BiomeSteps + temperature] = biome;
+            }
+        }
+    }
+}
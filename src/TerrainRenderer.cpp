@@ -1,126 +1,131 @@
 
 #include "TerrainRenderer.hpp"
 #include "TerrainChunk.hpp"
+#include "Log.hpp"
+#include "Messages.hpp"
+#include "Profiler.hpp"
 
 #include "SFML/Graphics/RenderTarget.hpp"
 #include <xyginext/ecs/Scene.hpp>
 #include <xyginext/ecs/components/Camera.hpp>
 #include <xyginext/ecs/components/Transform.hpp>
 #include <xyginext/util/Vector.hpp>
-#include <xyginext/util/Random.hpp>
 
-// Draw distance (radius from camera, in world units)
-constexpr float DrawDistance(3500.f);
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
 
+namespace
+{
+    // Stamped tile indices count across then down the tile sheet, 16px tiles with a 1px gap
+    const int SheetColumns(57);
+    const float SheetTileStride(17.f);
+
+    // Smallest resident table, twice the starting pool rounded up to a power of two
+    const std::size_t ResidentMinCapacity(64);
 
-TerrainRenderer::TerrainRenderer(xy::MessageBus& mb) :
+    std::size_t residentHash(sf::Vector2i index)
+    {
+        auto hash = static_cast<std::uint64_t>(chunkKey(index)) * 0x9E3779B97F4A7C15ull;
+        return static_cast<std::size_t>(hash ^ (hash >> 32));
+    }
+}
+
+TerrainRenderer::TerrainRenderer(xy::MessageBus& mb, const TerrainGenerator::Params& params, bool headless) :
     xy::System(mb, typeid(TerrainRenderer)),
-    m_noise(),
-    m_currentChunk()
+    m_generator(params),
+    m_headless(headless),
+    m_sheetTexture(nullptr)
 {
+    // Chunks live in the pool rather than the scene, so no entity carries this and none are ever added
     requireComponent<TerrainChunk>();
-    requireComponent<xy::Transform>();
-
-    m_noise.SetNoiseType(FastNoise::Cellular);
 
-    m_sheetTexture = &m_textures.get("assets/Roguelike_pack/Spritesheet/roguelikeSheet_transparent.png");
+    // Pay for every slot's storage up front
+    for (int i(0); i < ChunkPoolSize; i++)
+    {
+        addSlot();
+    }
 }
 
 
 void TerrainRenderer::process(float dt)
 {
-    // Get the camera position
+    PROFILE_SCOPE("TerrainRenderer::process");
+
+    // Get the camera position, then anything else chunks are kept around
     sf::Vector2f pos(0, 0);
     auto camEnt = getScene()->getActiveCamera();
     pos = camEnt.getComponent<xy::Transform>().getWorldTransform().transformPoint(pos);
 
-    // Get the chunk the camera is on
-    xy::Entity chunk;
-    for (auto& ent : getEntities())
+    m_streamFocuses.clear();
+    m_streamFocuses.push_back(pos);
+    m_streamFocuses.insert(m_streamFocuses.end(), m_focuses.begin(), m_focuses.end());
+
+    // If a chunk is outside the draw distance of every focus, free its slot
+    for (auto& slot : m_slots)
     {
-        auto& rect = m_drawList[ent.getIndex()].bounds;
-        if (rect.contains(pos))
+        if (slot.active && !isWanted(slot))
         {
-            chunk = ent;
-            break;
+            releaseChunk(slot);
         }
     }
 
-    // If the camera isn't on an existing chunk, add a new one
-    if (chunk == xy::Entity())
-    {
-        int x = pos.x / (ChunkSize * TileSize);
-        int y = pos.y / (ChunkSize * TileSize);
-        chunk = addChunk({ x,y });
-    }
-
-    // If the new chunk doesn't match the last one, update all surrounding chunks
-    if (chunk != m_currentChunk)
+    // Make sure the chunk each focus is on and all surrounding chunks are present
+    for (auto focus : m_streamFocuses)
     {
-        // Current chunk changed, make sure all surrounding chunks are present
-        m_currentChunk = chunk;
-        auto c = m_currentChunk.getComponent<TerrainChunk>().getIndex();
-
-        std::list<sf::Vector2i> surroundingChunks{
-            { c.x - 1, c.y - 1 }, // top left
-            { c.x    , c.y - 1 }, // top 
-            { c.x + 1, c.y - 1 }, // top right
-            { c.x - 1, c.y     }, // left
-            { c.x + 1, c.y     }, // right
-            { c.x - 1, c.y + 1 }, // bottom left
-            { c.x    , c.y + 1 }, // bottom
-            { c.x + 1, c.y + 1 }, // bottom right
-        };
-
-        // Remove any chunks already on the draw list
-        for (auto& ent : getEntities())
+        auto index = chunkAt(focus);
+        if (!findSlot(index))
         {
-            auto match = std::find_if(surroundingChunks.begin(), surroundingChunks.end(), [&ent](const sf::Vector2i& i) {
-                
-                auto index = ent.getComponent<TerrainChunk>().getIndex();
-                return (index.x == i.x) && (index.y == i.y);
-            });
-
-            if (match != surroundingChunks.end())
-            {
-                surroundingChunks.erase(match);
-            }
+            addChunk(index);
         }
 
-        // Add remaining chunks
-        for (auto& c : surroundingChunks)
+        for (int y(-1); y < 2; y++)
         {
-            addChunk(c);
+            for (int x(-1); x < 2; x++)
+            {
+                sf::Vector2i neighbour(index.x + x, index.y + y);
+                if (!findSlot(neighbour))
+                {
+                    addChunk(neighbour);
+                }
+            }
         }
-
     }
 
-    // If a chunk is outside the draw distance, remove it
-    // Based on chunk center position, not it's entirety
-    for (auto& ent : getEntities())
+    // Edits are batched up so a chunk's worth arriving at once only remeshes it once
+    for (auto& slot : m_slots)
     {
-        sf::FloatRect bounds = m_drawList[ent.getIndex()].bounds;
-        
-        sf::Vector2f chunkPos = { bounds.left + bounds.width / 2, bounds.top + bounds.height / 2 };
-
-        if (xy::Util::Vector::length(chunkPos - pos) > DrawDistance)
+        if (slot.active && slot.dirty)
         {
-            getScene()->destroyEntity(ent);
-            auto pos = ent.getComponent<TerrainChunk>().getIndex();
-            xy::Logger::log("Chunk removed at " + std::to_string(pos.x) + "," + std::to_string(pos.y));
+            if (!m_headless)
+            {
+                meshChunk(slot);
+            }
+            slot.dirty = false;
         }
     }
-
 }
 
-void TerrainRenderer::onEntityAdded(xy::Entity ent)
+void TerrainRenderer::meshChunk(ChunkSlot& slot)
 {
+    PROFILE_SCOPE("TerrainRenderer::mesh");
+
     // Gather the tile data from this chunk and create verts for it
-    auto chunk = ent.getComponent<TerrainChunk>();
-    auto pos = ent.getComponent<xy::Transform>().getPosition();
+    const auto& chunk = slot.chunk;
     auto chunkId = chunk.getIndex();
+    sf::Vector2f pos(chunkId.x * ChunkSize * TileSize, chunkId.y * ChunkSize * TileSize);
+
+    // A render snapshot may still be drawing the old mesh on another thread, if so the chunk moves to a spare
+    // Only the simulation thread copies or drops mesh handles, so the count can't rise or fall under this
+    if (slot.mesh.use_count() > 1)
+    {
+        m_spareMeshes.push_back(std::move(slot.mesh));
+        slot.mesh = takeMesh();
+    }
 
-    sf::VertexArray verts(sf::PrimitiveType::Quads);
+    // Clearing keeps the mesh's capacity, so once it's grown to fit a chunk this doesn't allocate
+    auto& verts = *slot.mesh;
+    verts.clear();
 
     for (int y(0); y < ChunkSize; y++)
     {
@@ -130,15 +135,15 @@ void TerrainRenderer::onEntityAdded(xy::Entity ent)
                 sf::Vector2f texPos;
 
                 // Check if it's land tile first
-                if (chunk.data[i].height > SeaLevel)
+                if (chunk.height[i] > SeaLevel)
                 {
-                    // Pick one of the random land tiles
-                    const std::vector<sf::Vector2f> landTiles =
-                    {
+                    // Each region uses one of the land tiles
+                    static const std::array<sf::Vector2f, 2> landTiles =
+                    {{
                         {85.f,0.f},
                         {85.f,17.f}
-                    };
-                    auto selection = xy::Util::Random::value(0, landTiles.size() - 1);
+                    }};
+                    auto selection = chunk.region[i] > 0.f ? 1 : 0;
                     texPos = landTiles[selection];
                     sf::Vector2f tileGfxSize(16.f, 16.f);
                     verts.append({ sf::Vector2f{ pos.x + x * TileSize, pos.y + y * TileSize }, texPos }); // top left
@@ -168,63 +173,63 @@ void TerrainRenderer::onEntityAdded(xy::Entity ent)
 
                     // Top left
                     if (i % ChunkSize && i - ChunkSize > 0)
-                        n |= chunk.data[i - 1 - ChunkSize].height > SeaLevel ? TL : 0;
+                        n |= chunk.height[i - 1 - ChunkSize] > SeaLevel ? TL : 0;
                     else
-                        n |= m_noise.GetSimplexFractal(chunkId.x* ChunkSize + x - 1, chunkId.y* ChunkSize + y - 1) > SeaLevel ? TL : 0;
+                        n |= m_generator.getHeight(chunkId.x* ChunkSize + x - 1, chunkId.y* ChunkSize + y - 1) > SeaLevel ? TL : 0;
 
                     // Top
                     if (i - ChunkSize > 0)
-                        n |= chunk.data[i - ChunkSize].height > SeaLevel ? T : 0;
+                        n |= chunk.height[i - ChunkSize] > SeaLevel ? T : 0;
                     else
-                        n |= m_noise.GetSimplexFractal(chunkId.x* ChunkSize + x, chunkId.y* ChunkSize + y - 1) > SeaLevel ? T : 0;
+                        n |= m_generator.getHeight(chunkId.x* ChunkSize + x, chunkId.y* ChunkSize + y - 1) > SeaLevel ? T : 0;
 
                     // Top Right
                     if ((i + 1 - ChunkSize) > 0 && (i + 1 - ChunkSize) % ChunkSize)
-                        n |= chunk.data[i + 1 - ChunkSize].height > SeaLevel ? TR : 0;
+                        n |= chunk.height[i + 1 - ChunkSize] > SeaLevel ? TR : 0;
                     else
-                        n |= m_noise.GetSimplexFractal(chunkId.x* ChunkSize + x + 1, chunkId.y* ChunkSize + y - 1) > SeaLevel ? TR : 0;
+                        n |= m_generator.getHeight(chunkId.x* ChunkSize + x + 1, chunkId.y* ChunkSize + y - 1) > SeaLevel ? TR : 0;
 
                     // Right
                     if (i + 1 < TileCount && (i + 1) % ChunkSize)
-                        n |= chunk.data[i + 1].height > SeaLevel ? R : 0;
+                        n |= chunk.height[i + 1] > SeaLevel ? R : 0;
                     else
-                        n |= m_noise.GetSimplexFractal(chunkId.x* ChunkSize + x + 1, chunkId.y* ChunkSize + y) > SeaLevel ? R : 0;
+                        n |= m_generator.getHeight(chunkId.x* ChunkSize + x + 1, chunkId.y* ChunkSize + y) > SeaLevel ? R : 0;
 
                     // Bottom Right
                     if ((i + 1) % ChunkSize && i < TileCount - ChunkSize)
-                        n |= chunk.data[i + 1 + ChunkSize].height > SeaLevel ? BR : 0;
+                        n |= chunk.height[i + 1 + ChunkSize] > SeaLevel ? BR : 0;
                     else
-                        n |= m_noise.GetSimplexFractal(chunkId.x* ChunkSize + x + 1, chunkId.y* ChunkSize + y + 1) > SeaLevel ? BR : 0;
+                        n |= m_generator.getHeight(chunkId.x* ChunkSize + x + 1, chunkId.y* ChunkSize + y + 1) > SeaLevel ? BR : 0;
 
                     // Bottom
                     if (i + ChunkSize < TileCount)
-                        n |= chunk.data[i + ChunkSize].height > SeaLevel ? B : 0;
+                        n |= chunk.height[i + ChunkSize] > SeaLevel ? B : 0;
                     else
-                        n |= m_noise.GetSimplexFractal(chunkId.x* ChunkSize + x, chunkId.y* ChunkSize + y + 1) > SeaLevel ? B : 0;
+                        n |= m_generator.getHeight(chunkId.x* ChunkSize + x, chunkId.y* ChunkSize + y + 1) > SeaLevel ? B : 0;
 
                     // Bottom Left
                     if (i + ChunkSize < TileCount &&  i % ChunkSize)
-                        n |= chunk.data[i + ChunkSize - 1].height > SeaLevel ? BL : 0;
+                        n |= chunk.height[i + ChunkSize - 1] > SeaLevel ? BL : 0;
                     else
-                        n |= m_noise.GetSimplexFractal(chunkId.x* ChunkSize + x - 1, chunkId.y* ChunkSize + y + 1) > SeaLevel ? BL : 0;
+                        n |= m_generator.getHeight(chunkId.x* ChunkSize + x - 1, chunkId.y* ChunkSize + y + 1) > SeaLevel ? BL : 0;
 
                     // Left
                     if (i % ChunkSize)
-                        n |= chunk.data[i - 1].height > SeaLevel ? L : 0;
+                        n |= chunk.height[i - 1] > SeaLevel ? L : 0;
                     else
-                        n |= m_noise.GetSimplexFractal(chunkId.x* ChunkSize + x - 1, chunkId.y* ChunkSize + y) > SeaLevel ? L : 0;
+                        n |= m_generator.getHeight(chunkId.x* ChunkSize + x - 1, chunkId.y* ChunkSize + y) > SeaLevel ? L : 0;
 
                     if (!n)
                     {
-                        // Completely surrounded by sea, pick a random sea tile
-                        std::vector<sf::Vector2f> seaTexPos =
-                        {
+                        // Completely surrounded by sea, pick a sea tile variant
+                        static const std::array<sf::Vector2f, 4> seaTexPos =
+                        {{
                             {51,17},
                             {0,0},
                             {17,0},
                             {51,68}
-                        };
-                        auto selection = xy::Util::Random::value(0, seaTexPos.size() - 1);
+                        }};
+                        auto selection = m_generator.getVariant(chunkId.x * ChunkSize + x, chunkId.y * ChunkSize + y, static_cast<int>(seaTexPos.size()));
                         texPos = seaTexPos[selection];
                     }
 
@@ -324,34 +329,293 @@ void TerrainRenderer::onEntityAdded(xy::Entity ent)
 
                     }
                 }
+
+                // Stamped maps draw their layers over whatever was generated
+                if (chunk.isStamped(i))
+                {
+                    for (int layer(0); layer < OverlayLayers; layer++)
+                    {
+                        auto tile = chunk.overlay[layer * TileCount + i];
+                        if (!tile)
+                            continue;
+
+                        texPos = { ((tile - 1) % SheetColumns) * SheetTileStride, ((tile - 1) / SheetColumns) * SheetTileStride };
+                        sf::Vector2f tileGfxSize(16.f, 16.f);
+                        verts.append({ sf::Vector2f{ pos.x + x * TileSize, pos.y + y * TileSize }, texPos }); // top left
+                        verts.append({ sf::Vector2f{ pos.x + x * TileSize + TileSize, pos.y + y * TileSize },{ texPos.x + tileGfxSize.x, texPos.y } }); // top right
+                        verts.append({ sf::Vector2f{ pos.x + x * TileSize + TileSize, pos.y + y * TileSize + TileSize },texPos + tileGfxSize }); // bottom right
+                        verts.append({ sf::Vector2f{ pos.x + x * TileSize, pos.y + y * TileSize + TileSize },{ texPos.x, texPos.y + tileGfxSize.y } }); // bottom left
+                    }
+                }
             }
     }
-    m_drawList[ent.getIndex()].verts = verts;
-    m_drawList[ent.getIndex()].bounds = verts.getBounds();
 }
 
-void TerrainRenderer::onEntityRemoved(xy::Entity ent)
+bool TerrainRenderer::isLand(sf::Vector2f worldPos) const
 {
-    auto verts = m_drawList.find(ent.getIndex());
-    if (verts != m_drawList.end())
-        m_drawList.erase(verts);
+    // Floor so negative positions land in the right tile
+    int tileX = static_cast<int>(std::floor(worldPos.x / TileSize));
+    int tileY = static_cast<int>(std::floor(worldPos.y / TileSize));
+    int chunkX = floorDiv(tileX, ChunkSize);
+    int chunkY = floorDiv(tileY, ChunkSize);
+
+    if (const auto* chunk = getChunk({ chunkX, chunkY }))
+        return chunk->isLand(tileX - chunkX * ChunkSize, tileY - chunkY * ChunkSize);
+
+    return m_stamps.covers(tileX, tileY) || m_generator.getHeight(tileX, tileY) > SeaLevel;
+}
+
+const TerrainChunk* TerrainRenderer::getChunk(sf::Vector2i index) const
+{
+    const auto* slot = findResident(index);
+    return slot ? &slot->chunk : nullptr;
+}
+
+void TerrainRenderer::editTile(const TileEdit& edit)
+{
+    auto index = m_edits.add(edit);
+    if (auto* slot = findSlot(index))
+    {
+        TerrainEdits::apply(slot->chunk, edit);
+        slot->dirty = true;
+    }
+}
+
+void TerrainRenderer::replaceLand(sf::Vector2i index, const std::vector<std::uint64_t>& land)
+{
+    auto* slot = findSlot(index);
+    if (!slot || land.size() != slot->chunk.land.size())
+        return;
+
+    // Only the tiles which differ, so the rest keep their generated heights and biomes
+    auto& chunk = slot->chunk;
+    for (int i(0); i < TileCount; i++)
+    {
+        bool wanted = (land[i >> 6] >> (i & 63)) & 1;
+        if (wanted != chunk.isLand(i % ChunkSize, i / ChunkSize))
+        {
+            TileEdit edit;
+            edit.x = index.x * ChunkSize + i % ChunkSize;
+            edit.y = index.y * ChunkSize + i / ChunkSize;
+            edit.land = wanted;
+            TerrainEdits::apply(chunk, edit);
+            slot->dirty = true;
+        }
+    }
 }
 
 void TerrainRenderer::draw(sf::RenderTarget& rt, sf::RenderStates states) const
 {
-    for (auto& chunk : m_drawList)
+    PROFILE_SCOPE("TerrainRenderer::draw");
+
+    states.texture = m_sheetTexture;
+    for (const auto& slot : m_slots)
+    {
+        if (slot.active)
+            rt.draw(*slot.mesh, states);
+    }
+}
+
+void TerrainRenderer::getVisibleMeshes(const sf::FloatRect& area, std::vector<Mesh>& meshes) const
+{
+    for (const auto& slot : m_slots)
+    {
+        if (slot.active && slot.mesh && slot.bounds.intersects(area))
+            meshes.push_back(slot.mesh);
+    }
+}
+
+void TerrainRenderer::adoptChunk(TerrainChunk& chunk)
+{
+    auto index = chunk.getIndex();
+    if (findSlot(index))
+        return;
+
+    LOG_INFO("Adopting chunk at {},{}", index.x, index.y);
+
+    auto& slot = freeSlot(index);
+    std::swap(slot.chunk, chunk);
+    activate(slot);
+}
+
+//private
+std::shared_ptr<sf::VertexArray> TerrainRenderer::takeMesh()
+{
+    auto spare = std::find_if(m_spareMeshes.begin(), m_spareMeshes.end(),
+        [](const std::shared_ptr<sf::VertexArray>& mesh) { return mesh.use_count() == 1; });
+
+    if (spare != m_spareMeshes.end())
+    {
+        auto mesh = std::move(*spare);
+        m_spareMeshes.erase(spare);
+        return mesh;
+    }
+
+    auto mesh = std::make_shared<sf::VertexArray>(sf::PrimitiveType::Quads, TileCount * 4);
+    mesh->clear();
+    return mesh;
+}
+
+TerrainRenderer::ChunkSlot* TerrainRenderer::findSlot(sf::Vector2i index)
+{
+    return findResident(index);
+}
+
+TerrainRenderer::ChunkSlot& TerrainRenderer::addChunk(sf::Vector2i index)
+{
+    LOG_INFO("Adding chunk at {},{}", index.x, index.y);
+
+    // Generation and meshing overwrite the slot's storage in place
+    auto& slot = freeSlot(index);
+    m_generator.generate(slot.chunk, index);
+    activate(slot);
+    return slot;
+}
+
+TerrainRenderer::ChunkSlot& TerrainRenderer::freeSlot(sf::Vector2i index)
+{
+    auto slot = std::find_if(m_slots.begin(), m_slots.end(), [](const ChunkSlot& s) { return !s.active; });
+    if (slot == m_slots.end() && m_slots.size() < ChunkPoolSize * m_streamFocuses.size())
+    {
+        // Each focus can keep a camera's worth of chunks loaded
+        return addSlot();
+    }
+
+    if (slot == m_slots.end())
+    {
+        // The pool covers everything within the draw distance, so this only happens on a big jump
+        LOG_WARNING("Chunk pool exhausted, reusing the furthest slot");
+        auto centre = [&](const ChunkSlot& s)
+        {
+            auto i = s.chunk.getIndex() - index;
+            return i.x * i.x + i.y * i.y;
+        };
+        slot = std::max_element(m_slots.begin(), m_slots.end(), [&](const ChunkSlot& a, const ChunkSlot& b) { return centre(a) < centre(b); });
+        releaseChunk(*slot);
+    }
+    return *slot;
+}
+
+void TerrainRenderer::activate(ChunkSlot& slot)
+{
+    auto index = slot.chunk.getIndex();
+
+    // Stamps go over the generated tiles and edits over both
+    m_stamps.applyTo(slot.chunk);
+    m_edits.applyTo(slot.chunk);
+    if (!m_headless)
+    {
+        meshChunk(slot);
+    }
+
+    const float chunkWorldSize = ChunkSize * TileSize;
+    slot.bounds = { index.x * chunkWorldSize, index.y * chunkWorldSize, chunkWorldSize, chunkWorldSize };
+    slot.active = true;
+    slot.dirty = false;
+    insertResident(slot);
+
+    auto* msg = postMessage<ChunkEvent>(ChunkMessage);
+    msg->type = ChunkEvent::Loaded;
+    msg->index = index;
+}
+
+void TerrainRenderer::releaseChunk(ChunkSlot& slot)
+{
+    slot.active = false;
+
+    eraseResident(slot);
+
+    auto index = slot.chunk.getIndex();
+    LOG_INFO("Chunk removed at {},{}", index.x, index.y);
+
+    auto* msg = postMessage<ChunkEvent>(ChunkMessage);
+    msg->type = ChunkEvent::Unloaded;
+    msg->index = index;
+}
+
+TerrainRenderer::ChunkSlot& TerrainRenderer::addSlot()
+{
+    m_slots.emplace_back();
+    auto& slot = m_slots.back();
+    slot.chunk.allocate();
+    if (!m_headless)
     {
-        states.texture = m_sheetTexture;
-        rt.draw(chunk.second.verts, states);
+        slot.mesh = takeMesh();
     }
+
+    // Keep the resident table at most half full, refiling everything active as the capacity changes
+    if (m_resident.size() < m_slots.size() * 2)
+    {
+        std::size_t capacity(ResidentMinCapacity);
+        while (capacity < m_slots.size() * 2)
+            capacity *= 2;
+
+        m_resident.assign(capacity, nullptr);
+        for (auto& s : m_slots)
+        {
+            if (s.active)
+                insertResident(s);
+        }
+    }
+    return slot;
 }
 
-xy::Entity TerrainRenderer::addChunk(sf::Vector2i index)
+TerrainRenderer::ChunkSlot* TerrainRenderer::findResident(sf::Vector2i index) const
 {
-    xy::Logger::log("Adding chunk at " + std::to_string(index.x) + "," + std::to_string(index.y));
-    auto newChunk = getScene()->createEntity();
-    newChunk.addComponent<TerrainChunk>().generate(m_noise, index);
-    newChunk.addComponent<xy::Transform>().setPosition(sf::Vector2f( index.x * TileSize * ChunkSize, index.y * TileSize * ChunkSize  ));
-    
-    return newChunk;
-}
\ No newline at end of file
+    auto mask = m_resident.size() - 1;
+    for (auto i = residentHash(index) & mask; m_resident[i]; i = (i + 1) & mask)
+    {
+        if (m_resident[i]->chunk.getIndex() == index)
+            return m_resident[i];
+    }
+    return nullptr;
+}
+
+void TerrainRenderer::insertResident(ChunkSlot& slot)
+{
+    auto mask = m_resident.size() - 1;
+    auto i = residentHash(slot.chunk.getIndex()) & mask;
+    while (m_resident[i])
+        i = (i + 1) & mask;
+    m_resident[i] = &slot;
+}
+
+void TerrainRenderer::eraseResident(const ChunkSlot& slot)
+{
+    auto mask = m_resident.size() - 1;
+    auto gap = residentHash(slot.chunk.getIndex()) & mask;
+    while (m_resident[gap] && m_resident[gap] != &slot)
+        gap = (gap + 1) & mask;
+
+    if (!m_resident[gap])
+        return;
+
+    // Shift the rest of the run back over the gap wherever that's no earlier than an entry's home,
+    // so lookups never stop short at an empty entry
+    m_resident[gap] = nullptr;
+    for (auto i = (gap + 1) & mask; m_resident[i]; i = (i + 1) & mask)
+    {
+        auto home = residentHash(m_resident[i]->chunk.getIndex()) & mask;
+        if (((i - home) & mask) >= ((i - gap) & mask))
+        {
+            m_resident[gap] = m_resident[i];
+            m_resident[i] = nullptr;
+            gap = i;
+        }
+    }
+}
+
+bool TerrainRenderer::isWanted(const ChunkSlot& slot) const
+{
+    // Based on chunk center position, not it's entirety, but the 3x3 around a focus always stays
+    // so nothing right next to it drops out while it stands still
+    auto index = slot.chunk.getIndex();
+    sf::Vector2f chunkPos = { slot.bounds.left + slot.bounds.width / 2, slot.bounds.top + slot.bounds.height / 2 };
+    for (auto focus : m_streamFocuses)
+    {
+        auto offset = index - chunkAt(focus);
+        if ((std::abs(offset.x) <= 1 && std::abs(offset.y) <= 1) || xy::Util::Vector::length(chunkPos - focus) <= DrawDistance)
+            return true;
+    }
+    return false;
+}
@@ -0,0 +1,438 @@
+#include "TileMap.hpp"
+
+#include <zlib.h>
+
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <future>
+#include <iterator>
+#include <utility>
+
+#include "Log.hpp"
+#include "Profiler.hpp"
+
+namespace
+{
+    // Tiled keeps flip flags in the top bits of each tile id
+    const std::uint32_t FlipFlags(0xe0000000);
+
+    // 0xff for anything which isn't a base64 digit
+    std::array<std::uint8_t, 256> makeBase64Table()
+    {
+        const std::string digits("ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/");
+        std::array<std::uint8_t, 256> table;
+        table.fill(0xff);
+        for (std::size_t i(0); i < digits.size(); i++)
+        {
+            table[static_cast<std::uint8_t>(digits[i])] = static_cast<std::uint8_t>(i);
+        }
+        return table;
+    }
+    const std::array<std::uint8_t, 256> Base64Table(makeBase64Table());
+
+    // Four digits at a time while they're all digits, one at a time around whitespace and the padding at the end
+    bool decodeBase64(const std::string& text, std::vector<std::uint8_t>& out)
+    {
+        out.resize(text.size() / 4 * 3 + 3);
+        auto* dst = out.data();
+
+        const auto* c = reinterpret_cast<const std::uint8_t*>(text.data());
+        const auto* end = c + text.size();
+
+        std::uint32_t bits = 0;
+        int count = 0;
+        while (c < end)
+        {
+            if (count == 0 && end - c >= 4)
+            {
+                std::uint32_t a = Base64Table[c[0]], b = Base64Table[c[1]], d = Base64Table[c[2]], e = Base64Table[c[3]];
+                if ((a | b | d | e) < 64)
+                {
+                    auto value = (a << 18) | (b << 12) | (d << 6) | e;
+                    *dst++ = static_cast<std::uint8_t>(value >> 16);
+                    *dst++ = static_cast<std::uint8_t>(value >> 8);
+                    *dst++ = static_cast<std::uint8_t>(value);
+                    c += 4;
+                    continue;
+                }
+            }
+
+            auto digit = *c++;
+            auto value = Base64Table[digit];
+            if (value < 64)
+            {
+                bits = (bits << 6) | value;
+                if (++count == 4)
+                {
+                    *dst++ = static_cast<std::uint8_t>(bits >> 16);
+                    *dst++ = static_cast<std::uint8_t>(bits >> 8);
+                    *dst++ = static_cast<std::uint8_t>(bits);
+                    bits = 0;
+                    count = 0;
+                }
+            }
+            else if (digit == '=')
+            {
+                break;
+            }
+            else if (!std::isspace(digit))
+            {
+                return false;
+            }
+        }
+
+        // A final group of two or three digits holds one or two bytes
+        if (count == 1)
+            return false;
+        if (count == 2)
+            *dst++ = static_cast<std::uint8_t>(bits >> 4);
+        if (count == 3)
+        {
+            *dst++ = static_cast<std::uint8_t>(bits >> 10);
+            *dst++ = static_cast<std::uint8_t>(bits >> 2);
+        }
+
+        out.resize(dst - out.data());
+        return true;
+    }
+
+    // The size is always known up front, a layer's width * height ids of four bytes each
+    bool inflateData(const std::vector<std::uint8_t>& in, std::vector<std::uint8_t>& out)
+    {
+        z_stream stream{};
+
+        // 15 + 32 takes either a zlib or a gzip header, Tiled writes both
+        if (inflateInit2(&stream, 15 + 32) != Z_OK)
+            return false;
+
+        stream.next_in = const_cast<Bytef*>(in.data());
+        stream.avail_in = static_cast<uInt>(in.size());
+        stream.next_out = out.data();
+        stream.avail_out = static_cast<uInt>(out.size());
+
+        auto result = inflate(&stream, Z_FINISH);
+        inflateEnd(&stream);
+        return result == Z_STREAM_END && stream.avail_out == 0;
+    }
+
+    struct LayerData
+    {
+        std::string name;
+        sf::Vector2i size;
+        std::string encoding;
+        std::string compression;
+        std::string text;
+    };
+
+    // A layer's tiles cut into one array per piece, in the map's piece order
+    struct DecodedLayer
+    {
+        bool valid = false;
+        std::vector<std::vector<std::uint16_t>> pieces;
+    };
+
+    DecodedLayer decodeLayer(const LayerData& layer, sf::Vector2i chunkCount, std::uint32_t firstGid)
+    {
+        PROFILE_SCOPE("TileMap::decodeLayer");
+
+        DecodedLayer decoded;
+        if (layer.encoding != "base64")
+        {
+            LOG_ERROR("Layer {} is {} encoded, only base64 is supported", layer.name, layer.encoding);
+            return decoded;
+        }
+
+        std::vector<std::uint8_t> bytes;
+        if (!decodeBase64(layer.text, bytes))
+        {
+            LOG_ERROR("Layer {} isn't valid base64", layer.name);
+            return decoded;
+        }
+
+        std::size_t tileCount = std::size_t(layer.size.x) * layer.size.y;
+        if (!layer.compression.empty())
+        {
+            std::vector<std::uint8_t> inflated(tileCount * 4);
+            if ((layer.compression != "zlib" && layer.compression != "gzip") || !inflateData(bytes, inflated))
+            {
+                LOG_ERROR("Couldn't decompress layer {} ({})", layer.name, layer.compression);
+                return decoded;
+            }
+            bytes.swap(inflated);
+        }
+
+        if (bytes.size() != tileCount * 4)
+        {
+            LOG_ERROR("Layer {} has {} bytes of tiles, expected {}", layer.name, bytes.size(), tileCount * 4);
+            return decoded;
+        }
+
+        decoded.pieces.resize(std::size_t(chunkCount.x) * chunkCount.y, std::vector<std::uint16_t>(TileCount));
+
+        // Little endian ids, flags masked off and rebased so 0 is empty and 1 is the sheet's first tile
+        const auto* id = bytes.data();
+        for (int y(0); y < layer.size.y; y++)
+        {
+            auto* row = &decoded.pieces[std::size_t(y / ChunkSize) * chunkCount.x];
+            auto rowStart = (y % ChunkSize) * ChunkSize;
+            for (int x(0); x < layer.size.x; x++, id += 4)
+            {
+                std::uint32_t gid = id[0] | (id[1] << 8) | (id[2] << 16) | (std::uint32_t(id[3]) << 24);
+                gid &= ~FlipFlags;
+
+                std::uint16_t tile = 0;
+                if (gid >= firstGid && gid - firstGid < 0xffff)
+                    tile = static_cast<std::uint16_t>(gid - firstGid + 1);
+
+                row[x / ChunkSize][rowStart + x % ChunkSize] = tile;
+            }
+        }
+
+        decoded.valid = true;
+        return decoded;
+    }
+
+    std::string unescape(const std::string& value)
+    {
+        static const std::array<std::pair<const char*, char>, 5> entities =
+        {{
+            { "&amp;", '&' }, { "&lt;", '<' }, { "&gt;", '>' }, { "&quot;", '"' }, { "&apos;", '\'' }
+        }};
+
+        std::string result;
+        for (std::size_t i(0); i < value.size(); i++)
+        {
+            bool replaced = false;
+            if (value[i] == '&')
+            {
+                for (const auto& entity : entities)
+                {
+                    if (value.compare(i, std::strlen(entity.first), entity.first) == 0)
+                    {
+                        result += entity.second;
+                        i += std::strlen(entity.first) - 1;
+                        replaced = true;
+                        break;
+                    }
+                }
+            }
+
+            if (!replaced)
+                result += value[i];
+        }
+        return result;
+    }
+
+    // The text between < and >, its name then name="value" pairs
+    struct Tag
+    {
+        std::string name;
+        std::vector<std::pair<std::string, std::string>> attributes;
+        bool closing = false;
+        bool empty = false; // <like/> with no content or closing tag
+
+        std::string get(const char* attribute) const
+        {
+            for (const auto& a : attributes)
+            {
+                if (a.first == attribute)
+                    return a.second;
+            }
+            return {};
+        }
+
+        int getInt(const char* attribute) const { return std::atoi(get(attribute).c_str()); }
+    };
+
+    Tag parseTag(const std::string& text)
+    {
+        const char* Space = " \t\r\n";
+
+        Tag tag;
+        tag.closing = !text.empty() && text[0] == '/';
+        tag.empty = !text.empty() && text.back() == '/';
+
+        auto start = tag.closing ? 1 : 0;
+        auto i = text.find_first_of(Space, start);
+        tag.name = text.substr(start, std::min(i, text.size() - (tag.empty ? 1 : 0)) - start);
+
+        while (i < text.size())
+        {
+            i = text.find_first_not_of(Space, i);
+            auto equals = text.find('=', i);
+            auto quote = text.find_first_of("\"'", equals);
+            if (i == std::string::npos || equals == std::string::npos || quote == std::string::npos)
+                break;
+
+            auto close = text.find(text[quote], quote + 1);
+            if (close == std::string::npos)
+                break;
+
+            auto name = text.substr(i, equals - i);
+            name.erase(name.find_last_not_of(Space) + 1);
+            tag.attributes.emplace_back(name, unescape(text.substr(quote + 1, close - quote - 1)));
+            i = close + 1;
+        }
+        return tag;
+    }
+}
+
+bool TileMap::loadFromFile(const std::string& path)
+{
+    PROFILE_SCOPE("TileMap::loadFromFile");
+
+    m_size = {};
+    m_chunkCount = {};
+    m_layerNames.clear();
+    m_pieces.clear();
+
+    std::ifstream file(path, std::ios::binary);
+    if (!file)
+    {
+        LOG_ERROR("Couldn't open map {}", path);
+        return false;
+    }
+
+    std::uint32_t firstGid = 0;
+    bool hasTileset = false;
+    std::vector<std::future<DecodedLayer>> layers;
+
+    LayerData layer;
+    bool inData = false;
+    bool valid = true;
+    std::string text;
+
+    // Only the open tags matter and the one element with content, so this is a tag scanner rather than a parser
+    std::istreambuf_iterator<char> c(file), end;
+    while (c != end && valid)
+    {
+        char next = *c++;
+        if (next != '<')
+        {
+            if (inData)
+                layer.text += next;
+            continue;
+        }
+
+        text.clear();
+        while (c != end && *c != '>')
+        {
+            text += *c++;
+        }
+        if (c == end)
+            break;
+        ++c;
+
+        // Declarations and comments
+        if (text.empty() || text[0] == '?' || text[0] == '!')
+            continue;
+
+        auto tag = parseTag(text);
+        if (tag.closing)
+        {
+            if (tag.name == "data" && inData)
+            {
+                inData = false;
+                if (!hasTileset || m_size != layer.size)
+                {
+                    LOG_ERROR("Layer {} in {} comes before the map's size or tile sheet", layer.name, path);
+                    valid = false;
+                    break;
+                }
+
+                // Decoding starts while the rest of the file is still being read
+                m_layerNames.push_back(layer.name);
+                layers.push_back(std::async(std::launch::async, decodeLayer, std::move(layer), m_chunkCount, firstGid));
+                layer = LayerData();
+            }
+        }
+        else if (tag.name == "map")
+        {
+            m_size = { tag.getInt("width"), tag.getInt("height") };
+            m_chunkCount = { (m_size.x + ChunkSize - 1) / ChunkSize, (m_size.y + ChunkSize - 1) / ChunkSize };
+
+            if (tag.get("orientation") != "orthogonal" || tag.getInt("infinite") != 0
+                || tag.getInt("tilewidth") != TileSize || tag.getInt("tileheight") != TileSize || m_size.x <= 0 || m_size.y <= 0)
+            {
+                LOG_ERROR("{} isn't a finite orthogonal map with {}px tiles", path, TileSize);
+                valid = false;
+            }
+        }
+        else if (tag.name == "tileset")
+        {
+            if (hasTileset)
+            {
+                LOG_WARNING("{} uses more than one tile sheet, only the first is supported", path);
+                continue;
+            }
+            firstGid = static_cast<std::uint32_t>(tag.getInt("firstgid"));
+            hasTileset = true;
+        }
+        else if (tag.name == "layer")
+        {
+            layer.name = tag.get("name");
+            layer.size = { tag.getInt("width"), tag.getInt("height") };
+            if (layer.size != m_size)
+            {
+                LOG_ERROR("Layer {} in {} isn't the size of the map", layer.name, path);
+                valid = false;
+            }
+        }
+        else if (tag.name == "data" && !tag.empty)
+        {
+            layer.encoding = tag.get("encoding");
+            layer.compression = tag.get("compression");
+            layer.text.clear();
+            inData = true;
+        }
+    }
+
+    // Every layer has to be waited for, even if one fails
+    std::vector<DecodedLayer> decoded;
+    for (auto& result : layers)
+    {
+        decoded.push_back(result.get());
+        valid = valid && decoded.back().valid;
+    }
+
+    if (!valid || !hasTileset || decoded.empty())
+    {
+        LOG_ERROR("Couldn't load map {}", path);
+        m_layerNames.clear();
+        return false;
+    }
+
+    // Layers were cut up in piece order, so each piece just collects its own from each
+    m_pieces.resize(decoded.front().pieces.size());
+    for (std::size_t i(0); i < m_pieces.size(); i++)
+    {
+        auto& piece = m_pieces[i];
+        piece.index = { static_cast<int>(i % m_chunkCount.x), static_cast<int>(i / m_chunkCount.x) };
+        piece.covered.assign(TileCount / 64, 0);
+
+        for (auto& layerTiles : decoded)
+        {
+            const auto& tiles = layerTiles.pieces[i];
+            for (int t(0); t < TileCount; t++)
+            {
+                piece.covered[t >> 6] |= std::uint64_t(tiles[t] != 0) << (t & 63);
+            }
+            piece.layers.push_back(std::move(layerTiles.pieces[i]));
+        }
+    }
+
+    LOG_INFO("Loaded map {}, {}x{} tiles in {} layers and {} pieces", path, m_size.x, m_size.y, m_layerNames.size(), m_pieces.size());
+    return true;
+}
+
+const MapPiece* TileMap::getPiece(sf::Vector2i index) const
+{
+    if (index.x < 0 || index.y < 0 || index.x >= m_chunkCount.x || index.y >= m_chunkCount.y)
+        return nullptr;
+
+    return &m_pieces[std::size_t(index.y) * m_chunkCount.x + index.x];
+}
@@ -0,0 +1,224 @@
+#include "World.hpp"
+
+#include <xyginext/ecs/components/Camera.hpp>
+#include <xyginext/ecs/components/SpriteAnimation.hpp>
+#include <xyginext/ecs/components/Transform.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <random>
+
+#include "BotController.hpp"
+#include "Collider.hpp"
+#include "EntityStreamer.hpp"
+#include "Input.hpp"
+#include "InputState.hpp"
+#include "LaunchOptions.hpp"
+#include "Log.hpp"
+#include "Physics.hpp"
+#include "PlayerController.hpp"
+#include "Prediction.hpp"
+#include "Profiler.hpp"
+#include "RenderInterpolator.hpp"
+#include "Replication.hpp"
+#include "SpatialGrid.hpp"
+#include "TerrainCollision.hpp"
+#include "TerrainRenderer.hpp"
+#include "TileMap.hpp"
+
+namespace
+{
+    // Steps run in one update before the rest of the backlog is dropped, so a long hitch
+    // slows the world down rather than leaving every later frame further behind
+    const int MaxCatchUpSteps(5);
+
+    // Entities in unloaded chunks, kept between runs
+    const std::string WorldSaveFile("world.sav");
+
+    // Bots are spread over a few chunks each way, so clients in different places see different ones
+    const float BotSpawnRadius(4.f * ChunkSize * TileSize);
+
+    // Tries at finding land for each bot, before leaving it wherever the last one landed
+    const int BotSpawnTries(16);
+
+    // Characters' feet, what's kept off the sea
+    const sf::FloatRect CharacterFeet(3.f, 10.f, 10.f, 6.f);
+
+    // Archetypes of streamed entities, saved with them so only ever add to the end
+    enum Archetype : std::uint16_t
+    {
+        BotArchetype
+    };
+
+    // Everything a bot has besides what EntityStreamer restores, it wanders around wherever it's put
+    void makeBot(xy::Entity ent)
+    {
+        ent.addComponent<xy::SpriteAnimation>();
+        ent.addComponent<InputState>();
+        ent.addComponent<Bot>().home = ent.getComponent<xy::Transform>().getPosition();
+        ent.addComponent<Collider>().bounds = CharacterFeet;
+        ent.addComponent<Replicated>();
+    }
+
+    // Handcrafted maps stamped over the generated terrain, by the world tile of their top left corner
+    // Clients and the server place the same ones so they agree on the land
+    struct MapPlacement
+    {
+        const char* path;
+        sf::Vector2i tile;
+    };
+    const std::array<MapPlacement, 2> MapPlacements =
+    {{
+        { "assets/Roguelike_pack/Map/sample_map.tmx", { -50, -50 } },
+        { "assets/Roguelike_pack/Map/sample_indoor.tmx", { 200, -50 } }
+    }};
+}
+
+World::World(xy::MessageBus& mb, bool headless, const TerrainGenerator::Params* terrain) :
+    m_scene(mb),
+    m_input(nullptr),
+    m_interpolator(nullptr),
+    m_timestep(1.f / getLaunchOptions().tickRate),
+    m_accumulator(0.f)
+{
+    m_input = &m_scene.addDirector<InputDirector>();
+
+    // A playback regenerates the world it was recorded in
+    const auto& options = getLaunchOptions();
+    int seed = options.seed;
+    if (!options.playbackPath.empty() && m_input->startPlayback(options.playbackPath))
+    {
+        seed = m_input->getPlaybackSeed();
+        m_timestep = m_input->getPlaybackTimestep();
+    }
+    else if (!options.recordPath.empty())
+    {
+        m_input->startRecording(options.recordPath, seed, m_timestep);
+    }
+
+    auto params = terrain ? *terrain : TerrainGenerator::defaultParams(seed);
+    seed = params.seed;
+
+    m_scene.addSystem<BotController>(mb, seed);
+    m_scene.addSystem<PredictionSystem>(mb);
+    m_scene.addSystem<PlayerController>(mb);
+    auto& renderer = m_scene.addSystem<TerrainRenderer>(mb, params, headless);
+    for (const auto& placement : MapPlacements)
+    {
+        // TileMap logs why if it can't be loaded, the world just goes without it
+        TileMap map;
+        if (map.loadFromFile(placement.path))
+            renderer.addStamp(map, placement.tile);
+    }
+    m_scene.addSystem<Physics>(mb);
+    m_scene.addSystem<TerrainCollision>(mb);
+    m_scene.addSystem<SpatialGrid>(mb);
+
+    // Recorded runs always start from a fresh world, and a joined client's streamed entities are the server's to keep
+    bool replaying = !options.playbackPath.empty() || !options.recordPath.empty();
+    auto& streamer = m_scene.addSystem<EntityStreamer>(mb, seed, replaying || terrain ? std::string() : WorldSaveFile);
+    streamer.registerArchetype(BotArchetype, makeBot);
+    m_scene.addSystem<ReplicationSystem>(mb);
+    m_interpolator = &m_scene.addSystem<RenderInterpolator>(mb);
+
+    // Player entity, WorldState gives it a sprite
+    m_player = createCharacter(PlayerOne);
+
+    // Camera entity, terrain streams around it so it's needed without a window too
+    auto cam = m_scene.createEntity();
+    cam.addComponent<xy::Transform>().setPosition(8, 8);
+    m_player.getComponent<xy::Transform>().addChild(cam.getComponent<xy::Transform>());
+    cam.addComponent<xy::Camera>().zoom(5.f);
+    m_scene.setActiveCamera(cam);
+}
+
+World::~World()
+{
+    m_scene.getSystem<EntityStreamer>().save();
+}
+
+void World::handleEvent(const sf::Event& evt)
+{
+    m_scene.forwardEvent(evt);
+}
+
+void World::handleMessage(const xy::Message& msg)
+{
+    m_scene.forwardMessage(msg);
+}
+
+int World::update(float dt)
+{
+    m_accumulator += dt;
+    int steps = 0;
+    while (m_accumulator >= m_timestep && steps < MaxCatchUpSteps)
+    {
+        m_interpolator->beginStep();
+        m_scene.update(m_timestep);
+        m_accumulator -= m_timestep;
+        steps++;
+    }
+
+    if (m_accumulator >= m_timestep)
+    {
+        LOG_DEBUG("Simulation fell behind, dropped {} steps", static_cast<int>(m_accumulator / m_timestep));
+        m_accumulator = std::fmod(m_accumulator, m_timestep);
+    }
+    return steps;
+}
+
+bool World::isRunning() const
+{
+    return !m_input->isPlaybackFinished();
+}
+
+xy::Entity World::spawnAvatar()
+{
+    return createCharacter(NoPlayer);
+}
+
+void World::spawnBots(int count)
+{
+    // Bots saved by an earlier run come back with their chunks, and count towards the total
+    auto saved = static_cast<int>(m_scene.getSystem<EntityStreamer>().getSuspendedCount());
+    count = std::max(count - saved, 0);
+
+    std::mt19937 random(static_cast<std::mt19937::result_type>(getLaunchOptions().seed));
+    std::uniform_real_distribution<float> position(-BotSpawnRadius, BotSpawnRadius);
+    const auto& terrain = m_scene.getSystem<TerrainRenderer>();
+    sf::Vector2f feet(CharacterFeet.left + CharacterFeet.width / 2.f, CharacterFeet.top + CharacterFeet.height / 2.f);
+
+    for (int i(0); i < count; i++)
+    {
+        sf::Vector2f home;
+        for (int tries(0); tries < BotSpawnTries; tries++)
+        {
+            home = { std::round(position(random)), std::round(position(random)) };
+            if (terrain.isLand(home + feet))
+                break;
+        }
+
+        // Anything outside the loaded chunks is suspended on the next residency check, until a client comes near
+        auto ent = m_scene.createEntity();
+        ent.addComponent<xy::Transform>().setPosition(home);
+        ent.addComponent<Streamed>().archetype = BotArchetype;
+        makeBot(ent);
+    }
+    LOG_INFO("Spawned {} bots, {} more saved", count, saved);
+}
+
+//private
+xy::Entity World::createCharacter(Player player)
+{
+    auto ent = m_scene.createEntity();
+
+    // George is 48px tall, but our tiles are 16x16
+    ent.addComponent<xy::Transform>().setScale(1.f / 3.f, 1.f / 3.f);
+    ent.addComponent<xy::SpriteAnimation>();
+    ent.addComponent<InputState>().player = player;
+    ent.addComponent<Interpolated>().snapToPixels = true; // As PlayerController::walk, or blending would bring the shimmer back
+    ent.addComponent<Collider>().bounds = CharacterFeet;
+    ent.addComponent<Replicated>();
+    return ent;
+}
@@ -0,0 +1,405 @@
+#include "WorldClient.hpp"
+
+#include <SFML/Network/SocketSelector.hpp>
+#include <xyginext/core/Message.hpp>
+#include <xyginext/ecs/Scene.hpp>
+#include <xyginext/ecs/components/NetInterpolation.hpp>
+#include <xyginext/ecs/components/SpriteAnimation.hpp>
+#include <xyginext/ecs/components/Transform.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+#include "Log.hpp"
+#include "Messages.hpp"
+#include "Prediction.hpp"
+#include "Profiler.hpp"
+#include "TerrainRenderer.hpp"
+#include "World.hpp"
+
+namespace
+{
+    // How long to wait for the server to answer, both connecting and for the world info
+    const float JoinTimeout(5.f);
+}
+
+WorldClient::WorldClient(const LinkConditions& conditions) :
+    m_params(TerrainGenerator::defaultParams(0)),
+    m_clientID(0),
+    m_verifiedChunks(0),
+    m_mismatchedChunks(0),
+    m_datagrams(conditions),
+    m_serverPort(0),
+    m_hasSnapshot(false),
+    m_newest(0),
+    m_newestApplied(true),
+    m_serverTick(0),
+    m_avatarID(0),
+    m_hasAppliedInput(false),
+    m_appliedInput(0),
+    m_snapshotsReceived(0),
+    m_snapshotsMissingBaseline(0),
+    m_snapshotBytes(0)
+{
+    m_datagram.reserve(MaxDatagramSize);
+}
+
+bool WorldClient::join(const std::string& address, unsigned short port)
+{
+    LOG_INFO("Joining {}:{}", address, port);
+
+    auto& socket = m_connection.getSocket();
+    if (socket.connect(address, port, sf::seconds(JoinTimeout)) != sf::Socket::Done)
+    {
+        LOG_ERROR("Couldn't connect to {}:{}", address, port);
+        return false;
+    }
+
+    // The world info is the first thing the server sends
+    sf::SocketSelector selector;
+    selector.add(socket);
+
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::duration<float>(JoinTimeout);
+    sf::Packet packet;
+    while (!m_connection.receive(packet))
+    {
+        if (!m_connection.isConnected() || std::chrono::steady_clock::now() > deadline)
+        {
+            LOG_ERROR("Server didn't send the world info");
+            return false;
+        }
+        selector.wait(sf::milliseconds(100));
+    }
+
+    sf::Uint8 id = 0;
+    sf::Uint16 protocol = 0;
+    sf::Uint32 clientID = 0;
+    sf::Uint32 version = 0;
+    packet >> id >> protocol >> clientID;
+    if (id != WorldInfoPacket || protocol != ProtocolVersion)
+    {
+        LOG_ERROR("Server uses protocol {}, this build uses {}", protocol, ProtocolVersion);
+        return false;
+    }
+
+    packet >> version >> m_params;
+    auto hash = readHash(packet);
+    if (!packet || version != TerrainGenerator::Version)
+    {
+        LOG_ERROR("Server uses terrain generator {}, this build uses {}", version, TerrainGenerator::Version);
+        return false;
+    }
+
+    // Same version but a different hash means the parameters didn't arrive intact
+    if (hash != TerrainGenerator::hashParams(m_params))
+    {
+        LOG_ERROR("Terrain parameters from the server don't match their hash");
+        return false;
+    }
+
+    if (!TerrainGenerator::isSane(m_params))
+    {
+        LOG_ERROR("Server sent terrain parameters this build can't generate");
+        return false;
+    }
+
+    // Snapshots come back to wherever the acks are sent from
+    if (!m_datagrams.bind(0))
+    {
+        LOG_ERROR("Couldn't open a port for snapshots");
+        return false;
+    }
+    m_clientID = clientID;
+    m_serverAddress = socket.getRemoteAddress();
+    m_serverPort = port;
+
+    LOG_INFO("Joined world with seed {} as client {}", m_params.seed, m_clientID);
+    return true;
+}
+
+void WorldClient::handleMessage(const xy::Message& msg)
+{
+    if (msg.id != ChunkMessage)
+        return;
+
+    const auto& data = msg.getData<ChunkEvent>();
+    if (data.type == ChunkEvent::Loaded)
+    {
+        sf::Packet packet;
+        packet << static_cast<sf::Uint8>(ChunkRequestPacket) << data.index;
+        m_connection.send(packet);
+    }
+}
+
+void WorldClient::update(World& world)
+{
+    PROFILE_SCOPE("WorldClient::update");
+
+    if (!m_connection.isConnected())
+        return;
+
+    auto& terrain = world.getScene().getSystem<TerrainRenderer>();
+    sf::Packet packet;
+    while (m_connection.receive(packet))
+    {
+        handlePacket(packet, terrain);
+    }
+
+    receiveSnapshots();
+    applySnapshot(world);
+    sendAck(world);
+    sendInputs(world);
+    m_datagrams.update();
+
+    if (!m_connection.flush())
+    {
+        LOG_WARNING("Lost connection to the server, {} chunks verified, {} mismatched, {} bytes of terrain received",
+            m_verifiedChunks, m_mismatchedChunks, m_connection.getBytesReceived());
+        LOG_INFO("{} snapshots received, {} dropped for a missing baseline", m_snapshotsReceived, m_snapshotsMissingBaseline);
+    }
+}
+
+//private
+void WorldClient::handlePacket(sf::Packet& packet, TerrainRenderer& terrain)
+{
+    sf::Uint8 id = 0;
+    packet >> id;
+
+    switch (id)
+    {
+    case ChunkInfoPacket:
+    {
+        sf::Vector2i index;
+        sf::Uint32 count = 0;
+        packet >> index;
+        auto hash = readHash(packet);
+        packet >> count;
+
+        TileEdit edit;
+        for (sf::Uint32 i(0); i < count && packet >> edit; i++)
+        {
+            terrain.editTile(edit);
+        }
+
+        // The chunk may have streamed out again while the request was in flight, the edits are kept for when it's back
+        const auto* chunk = terrain.getChunk(index);
+        if (!chunk)
+            break;
+
+        if (chunk->contentHash == hash)
+        {
+            m_verifiedChunks++;
+        }
+        else
+        {
+            m_mismatchedChunks++;
+            LOG_WARNING("Chunk {},{} doesn't match the server's, requesting its land", index.x, index.y);
+
+            sf::Packet request;
+            request << static_cast<sf::Uint8>(LandRequestPacket) << index;
+            m_connection.send(request);
+        }
+        break;
+    }
+
+    case LandPacket:
+    {
+        sf::Vector2i index;
+        packet >> index;
+
+        std::vector<std::uint64_t> land(TileCount / 64);
+        for (auto& word : land)
+        {
+            sf::Uint64 value = 0;
+            packet >> value;
+            word = value;
+        }
+
+        if (packet)
+            terrain.replaceLand(index, land);
+        break;
+    }
+
+    case TileEditPacket:
+    {
+        TileEdit edit;
+        if (packet >> edit)
+            terrain.editTile(edit);
+        break;
+    }
+
+    default:
+        LOG_WARNING("Unexpected packet {} from the server", static_cast<int>(id));
+        break;
+    }
+}
+
+void WorldClient::receiveSnapshots()
+{
+    const std::uint8_t* data = nullptr;
+    std::size_t size = 0;
+    sf::IpAddress address;
+    unsigned short port = 0;
+
+    while (m_datagrams.receive(data, size, address, port))
+    {
+        if (address != m_serverAddress || port != m_serverPort)
+            continue;
+
+        BitReader reader(data, size);
+        auto id = reader.read(8);
+        auto sequence = static_cast<std::uint16_t>(reader.read(16));
+        bool hasBaseline = reader.readBool();
+        auto baselineSequence = static_cast<std::uint16_t>(reader.read(16));
+        auto avatarID = reader.readVar();
+        if (!reader.isValid() || id != SnapshotDatagram)
+            continue;
+
+        // Late arrivals are still kept as the server may pick them as a baseline,
+        // unless they're duplicates or so late their slot now belongs to a newer one
+        if (m_hasSnapshot && (m_received[sequence % SnapshotHistory].sequence == sequence
+            || !isNewer(static_cast<std::uint16_t>(sequence + SnapshotHistory), m_newest)))
+            continue;
+
+        static const Snapshot NoBaseline;
+        const Snapshot* baseline = &NoBaseline;
+        if (hasBaseline)
+        {
+            baseline = &m_received[baselineSequence % SnapshotHistory];
+            if (baseline->sequence != baselineSequence)
+            {
+                m_snapshotsMissingBaseline++;
+                continue;
+            }
+        }
+
+        Snapshot snapshot;
+        bool valid = readSnapshot(reader, *baseline, snapshot);
+        bool hasAppliedInput = reader.readBool();
+        auto appliedInput = static_cast<std::uint16_t>(reader.read(16));
+        if (!valid || !reader.isValid())
+        {
+            LOG_WARNING("Malformed snapshot {}", sequence);
+            continue;
+        }
+        snapshot.sequence = sequence;
+        if (m_snapshotCallback)
+            m_snapshotCallback(snapshot, avatarID);
+
+        m_received[sequence % SnapshotHistory] = std::move(snapshot);
+        m_snapshotsReceived++;
+        m_snapshotBytes += size;
+
+        if (!m_hasSnapshot || isNewer(sequence, m_newest))
+        {
+            if (m_hasSnapshot)
+                m_serverTick += static_cast<std::int16_t>(sequence - m_newest);
+
+            m_newest = sequence;
+            m_hasSnapshot = true;
+            m_newestApplied = false;
+            m_avatarID = avatarID;
+            m_hasAppliedInput = hasAppliedInput;
+            m_appliedInput = appliedInput;
+        }
+    }
+}
+
+void WorldClient::applySnapshot(World& world)
+{
+    if (!m_hasSnapshot || m_newestApplied)
+        return;
+
+    m_newestApplied = true;
+    const auto& snapshot = m_received[m_newest % SnapshotHistory];
+    auto& scene = world.getScene();
+
+    // Server time in milliseconds, which NetInterpolate buffers targets by
+    auto timestamp = static_cast<std::int32_t>(m_serverTick * world.getTimestep() * 1000.f);
+
+    for (const auto& state : snapshot.entities)
+    {
+        // This client's own avatar is the local player, predicted rather than mirrored
+        if (state.id == m_avatarID)
+        {
+            if (m_hasAppliedInput)
+                scene.getSystem<PredictionSystem>().reconcile(m_appliedInput, getPosition(state));
+            continue;
+        }
+
+        auto& entity = m_entities[state.id];
+        if (entity == xy::Entity())
+        {
+            entity = scene.createEntity();
+            entity.addComponent<xy::Transform>().setPosition(getPosition(state));
+            entity.addComponent<xy::SpriteAnimation>();
+            entity.addComponent<xy::NetInterpolate>();
+            if (m_spawnCallback)
+                m_spawnCallback(entity);
+        }
+
+        entity.getComponent<xy::NetInterpolate>().setTarget(getPosition(state), 0.f, timestamp);
+
+        auto& animation = entity.getComponent<xy::SpriteAnimation>();
+        if (state.animation & 0x80)
+            animation.play(state.animation & 0x7f);
+        else
+            animation.pause();
+    }
+
+    // Anything the snapshot no longer has has gone on the server
+    for (auto e = m_entities.begin(); e != m_entities.end();)
+    {
+        auto id = e->first;
+        auto found = std::lower_bound(snapshot.entities.begin(), snapshot.entities.end(), id,
+            [](const EntitySnapshot& state, std::uint32_t i) { return state.id < i; });
+
+        if (found == snapshot.entities.end() || found->id != id)
+        {
+            scene.destroyEntity(e->second);
+            e = m_entities.erase(e);
+        }
+        else
+        {
+            ++e;
+        }
+    }
+}
+
+void WorldClient::sendAck(World& world)
+{
+    // Where terrain streams around, the server only sends the entities in the chunks this has loaded
+    auto camera = world.getScene().getActiveCamera();
+    auto focus = camera.getComponent<xy::Transform>().getWorldTransform().transformPoint({});
+
+    // Sent every frame, even before the first snapshot, as it's also how the server learns where to send them
+    BitWriter writer(m_datagram);
+    writer.write(AckDatagram, 8);
+    writer.write(m_clientID, 32);
+    writer.writeBool(m_hasSnapshot);
+    writer.write(m_newest, 16);
+    writePosition(writer, focus);
+    m_datagrams.send(m_datagram, m_serverAddress, m_serverPort);
+}
+
+void WorldClient::sendInputs(World& world)
+{
+    // Every input the server hasn't applied yet, up to a limit, so any one datagram arriving makes up for those lost
+    const auto& pending = world.getScene().getSystem<PredictionSystem>().getHistory().getPending();
+    if (pending.empty())
+        return;
+
+    auto count = std::min(pending.size(), MaxInputsPerDatagram);
+    BitWriter writer(m_datagram);
+    writer.write(InputDatagram, 8);
+    writer.write(m_clientID, 32);
+    writer.write(pending.back().sequence, 16);
+    writer.write(static_cast<std::uint32_t>(count), 6);
+    for (auto frame = pending.rbegin(); frame != pending.rbegin() + static_cast<std::ptrdiff_t>(count); ++frame)
+    {
+        writer.write(static_cast<std::uint8_t>(frame->x), 8);
+        writer.write(static_cast<std::uint8_t>(frame->y), 8);
+    }
+    m_datagrams.send(m_datagram, m_serverAddress, m_serverPort);
+}
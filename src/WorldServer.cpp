@@ -0,0 +1,534 @@
+#include "WorldServer.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include <xyginext/ecs/Scene.hpp>
+#include <xyginext/ecs/components/Transform.hpp>
+
+#include "InputState.hpp"
+#include "Log.hpp"
+#include "NetProtocol.hpp"
+#include "Profiler.hpp"
+#include "Replication.hpp"
+#include "TerrainRenderer.hpp"
+#include "World.hpp"
+
+namespace
+{
+    // Deltas against nothing are full snapshots
+    const Snapshot NoBaseline;
+
+    // Type, sequence, baseline flag, baseline sequence and avatar id, then the terminating bit and the applied input
+    const std::size_t HeaderBits(8 + 16 + 1 + 16 + 34 + 1 + 1 + 16);
+
+    // Inputs held for an avatar, beyond this the oldest are dropped rather than letting its latency grow
+    const std::size_t MaxQueuedInputs(4);
+
+    // Continuation bit and an id gap under 256, and the removed flag for removals
+    const std::size_t IDBits(1 + 10);
+    const std::size_t RemovalBits(IDBits + 1);
+
+    // Changed entities are sent every step this close to the client's focus, further out
+    // the rate falls off with distance down to one step in four
+    const float FullRateDistance(512.f);
+    const float MinUpdateWeight(0.25f);
+
+    // Whether the client will have an entity's state from this step
+    bool hasCurrentState(const Snapshot& visible, const Snapshot& current, std::uint32_t id)
+    {
+        auto byID = [](const EntitySnapshot& e, std::uint32_t i) { return e.id < i; };
+        auto sent = std::lower_bound(visible.entities.begin(), visible.entities.end(), id, byID);
+        auto live = std::lower_bound(current.entities.begin(), current.entities.end(), id, byID);
+        return sent != visible.entities.end() && sent->id == id
+            && live != current.entities.end() && live->id == id && sameState(*sent, *live);
+    }
+
+    float getUpdateWeight(sf::Vector2f position, sf::Vector2f focus)
+    {
+        float distance = std::hypot(position.x - focus.x, position.y - focus.y);
+        if (distance <= FullRateDistance)
+            return 1.f;
+
+        return std::max(FullRateDistance / distance, MinUpdateWeight);
+    }
+}
+
+WorldServer::WorldServer(World& world, const LinkConditions& conditions) :
+    m_world(world),
+    m_terrain(world.getScene().getSystem<TerrainRenderer>()),
+    m_listening(false),
+    m_pending(std::make_unique<Client>()),
+    m_nextID(1),
+    m_datagrams(conditions)
+{
+    m_scratch.allocate();
+    m_datagram.reserve(MaxDatagramSize);
+}
+
+WorldServer::~WorldServer()
+{
+    for (const auto& client : m_clients)
+    {
+        logStats(*client);
+    }
+}
+
+bool WorldServer::listen(unsigned short port)
+{
+    if (m_listener.listen(port) != sf::Socket::Done || !m_datagrams.bind(port))
+    {
+        LOG_ERROR("Couldn't listen on port {}", port);
+        return false;
+    }
+
+    m_listener.setBlocking(false);
+    m_listening = true;
+    LOG_INFO("Listening on port {}", port);
+    return true;
+}
+
+void WorldServer::update()
+{
+    PROFILE_SCOPE("WorldServer::update");
+
+    if (!m_listening)
+        return;
+
+    accept();
+
+    sf::Packet packet;
+    for (auto& client : m_clients)
+    {
+        while (client->connection.receive(packet))
+        {
+            handlePacket(*client, packet);
+        }
+        client->connection.flush();
+    }
+
+    auto dropped = std::remove_if(m_clients.begin(), m_clients.end(), [&](const std::unique_ptr<Client>& c)
+    {
+        if (c->connection.isConnected())
+            return false;
+
+        LOG_INFO("Client {} left", c->id);
+        logStats(*c);
+        m_interest.removeClient(c->id);
+        m_world.getScene().destroyEntity(c->avatar);
+        return true;
+    });
+    m_clients.erase(dropped, m_clients.end());
+
+    receiveDatagrams();
+    m_interest.update(m_world.getScene().getSystem<ReplicationSystem>().getSnapshot());
+    for (auto& client : m_clients)
+    {
+        if (client->port != 0)
+            sendSnapshot(*client);
+    }
+
+    // After the snapshots, which report what was applied for the step they came from
+    applyInputs();
+    m_datagrams.update();
+
+    // Collision here only sees resident chunks, so keep every avatar's surroundings loaded as its client has them
+    m_focuses.clear();
+    for (const auto& client : m_clients)
+    {
+        m_focuses.push_back(client->avatar.getComponent<xy::Transform>().getPosition());
+    }
+    m_terrain.setFocuses(m_focuses);
+}
+
+void WorldServer::editTile(const TileEdit& edit)
+{
+    m_terrain.editTile(edit);
+
+    sf::Packet packet;
+    packet << static_cast<sf::Uint8>(TileEditPacket) << edit;
+    for (auto& client : m_clients)
+    {
+        client->connection.send(packet);
+    }
+}
+
+//private
+void WorldServer::accept()
+{
+    while (m_listener.accept(m_pending->connection.getSocket()) == sf::Socket::Done)
+    {
+        auto& client = *m_pending;
+        client.id = m_nextID++;
+        client.avatar = m_world.spawnAvatar();
+        LOG_INFO("Client {} joined from {}", client.id, client.connection.getSocket().getRemoteAddress().toString());
+
+        // Everything the client needs to build the same terrain, the hash lets it check its generator agrees
+        const auto& params = m_terrain.getGenerator().getParams();
+        sf::Packet packet;
+        packet << static_cast<sf::Uint8>(WorldInfoPacket) << static_cast<sf::Uint16>(ProtocolVersion) << static_cast<sf::Uint32>(client.id);
+        packet << static_cast<sf::Uint32>(TerrainGenerator::Version) << params;
+        writeHash(packet, TerrainGenerator::hashParams(params));
+        client.connection.send(packet);
+
+        m_clients.push_back(std::move(m_pending));
+        m_pending = std::make_unique<Client>();
+    }
+}
+
+void WorldServer::handlePacket(Client& client, sf::Packet& packet)
+{
+    sf::Uint8 id = 0;
+    sf::Vector2i index;
+    if (!(packet >> id >> index))
+    {
+        LOG_WARNING("Malformed packet from client {}", client.id);
+        return;
+    }
+
+    sf::Packet reply;
+    switch (id)
+    {
+    case ChunkRequestPacket:
+    {
+        const auto& edits = m_terrain.getEdits().getChunkEdits(index);
+        reply << static_cast<sf::Uint8>(ChunkInfoPacket) << index;
+        writeHash(reply, getChunkHash(index));
+        reply << static_cast<sf::Uint32>(edits.size());
+        for (const auto& edit : edits)
+        {
+            reply << edit;
+        }
+        break;
+    }
+
+    case LandRequestPacket:
+    {
+        LOG_WARNING("Client {} generated chunk {},{} differently, sending its land mask", client.id, index.x, index.y);
+        const auto& chunk = getEditedChunk(index);
+        reply << static_cast<sf::Uint8>(LandPacket) << index;
+        for (auto word : chunk.land)
+        {
+            reply << static_cast<sf::Uint64>(word);
+        }
+        break;
+    }
+
+    default:
+        LOG_WARNING("Unexpected packet {} from client {}", static_cast<int>(id), client.id);
+        return;
+    }
+    client.connection.send(reply);
+}
+
+void WorldServer::receiveDatagrams()
+{
+    const std::uint8_t* data = nullptr;
+    std::size_t size = 0;
+    sf::IpAddress address;
+    unsigned short port = 0;
+
+    while (m_datagrams.receive(data, size, address, port))
+    {
+        BitReader reader(data, size);
+        auto id = reader.read(8);
+        auto clientID = reader.read(32);
+        if (!reader.isValid())
+            continue;
+
+        auto client = std::find_if(m_clients.begin(), m_clients.end(), [clientID](const std::unique_ptr<Client>& c) { return c->id == clientID; });
+        if (client == m_clients.end())
+            continue;
+
+        // Only from the address the client joined from, so nobody else can redirect its snapshots or move its avatar
+        auto& c = **client;
+        if (address != c.connection.getSocket().getRemoteAddress())
+            continue;
+
+        switch (id)
+        {
+        case AckDatagram:
+            c.address = address;
+            c.port = port;
+            receiveAck(c, reader);
+            break;
+        case InputDatagram:
+            receiveInputs(c, reader);
+            break;
+        default:
+            break;
+        }
+    }
+}
+
+void WorldServer::receiveAck(Client& client, BitReader& reader)
+{
+    bool hasAck = reader.readBool();
+    auto acked = static_cast<std::uint16_t>(reader.read(16));
+    auto focus = readPosition(reader);
+    if (!reader.isValid())
+        return;
+
+    m_interest.setFocus(client.id, focus);
+
+    // Acks can arrive out of order, only ever move forward
+    if (hasAck && (!client.hasAck || isNewer(acked, client.acked)))
+    {
+        client.acked = acked;
+        client.hasAck = true;
+    }
+}
+
+void WorldServer::receiveInputs(Client& client, BitReader& reader)
+{
+    auto newest = static_cast<std::uint16_t>(reader.read(16));
+    auto count = reader.read(6);
+
+    InputFrame frames[MaxInputsPerDatagram];
+    count = std::min<std::uint32_t>(count, MaxInputsPerDatagram);
+    for (std::uint32_t i(0); i < count; i++)
+    {
+        auto& frame = frames[i];
+        frame.sequence = static_cast<std::uint16_t>(newest - i);
+        frame.x = static_cast<std::int8_t>(reader.read(8));
+        frame.y = static_cast<std::int8_t>(reader.read(8));
+    }
+
+    if (!reader.isValid())
+        return;
+
+    // Newest first on the wire, so queue from the back, skipping whatever's already queued or applied
+    for (auto i = count; i > 0; i--)
+    {
+        const auto& frame = frames[i - 1];
+        if (client.hasQueued && !isNewer(frame.sequence, client.lastQueued))
+            continue;
+
+        client.inputs.push_back(frame);
+        client.lastQueued = frame.sequence;
+        client.hasQueued = true;
+
+        if (client.inputs.size() > MaxQueuedInputs)
+        {
+            client.inputs.pop_front();
+            client.inputsDropped++;
+        }
+    }
+}
+
+void WorldServer::applyInputs()
+{
+    for (auto& client : m_clients)
+    {
+        auto& input = client->avatar.getComponent<InputState>();
+        if (client->inputs.empty())
+        {
+            // Stands still until more arrive, the client has already moved for them so it catches up when they do
+            input.movement = {};
+            if (client->hasQueued)
+                client->inputsStarved++;
+            continue;
+        }
+
+        const auto& frame = client->inputs.front();
+        input.movement = getMovement(frame);
+        client->lastApplied = frame.sequence;
+        client->hasApplied = true;
+        client->inputsApplied++;
+        client->inputs.pop_front();
+    }
+}
+
+void WorldServer::sendSnapshot(Client& client)
+{
+    PROFILE_SCOPE("WorldServer::sendSnapshot");
+
+    const auto& snapshot = m_world.getScene().getSystem<ReplicationSystem>().getSnapshot();
+    const auto& relevant = m_interest.getRelevant(client.id);
+    auto focus = m_interest.getFocus(client.id);
+    auto avatarID = client.avatar.getComponent<Replicated>().id;
+
+    // The acknowledged snapshot is only usable while it's still in the history
+    const Snapshot* baseline = &NoBaseline;
+    if (client.hasAck && client.sent[client.acked % SnapshotHistory].sequence == client.acked)
+        baseline = &client.sent[client.acked % SnapshotHistory];
+
+    // Starts as what the client already has of each relevant entity, due entities are swapped in below
+    // Anything in the baseline which isn't relevant any more is left out, so it's sent as a removal
+    m_relevant.sequence = snapshot.sequence;
+    m_relevant.entities.clear();
+    m_candidates.clear();
+    std::size_t reserved = HeaderBits;
+
+    auto b = baseline->entities.begin();
+    for (auto i : relevant)
+    {
+        const auto& e = snapshot.entities[i];
+        for (; b != baseline->entities.end() && b->id < e.id; ++b)
+        {
+            reserved += RemovalBits;
+            client.priority.erase(b->id);
+        }
+
+        const EntitySnapshot* base = nullptr;
+        if (b != baseline->entities.end() && b->id == e.id)
+            base = &*b++;
+
+        if (base && sameState(e, *base))
+        {
+            m_relevant.entities.push_back(e);
+            client.priority.erase(e.id);
+            continue;
+        }
+
+        // New entities are due straight away, changed ones as often as their distance allows,
+        // and the client's own avatar ahead of everything as its prediction is reconciled against it
+        auto& priority = client.priority[e.id];
+        if (e.id == avatarID)
+            priority = std::numeric_limits<float>::max();
+        else
+            priority += base ? getUpdateWeight(getPosition(e), focus) : 1.f;
+
+        if (priority >= 1.f)
+        {
+            Candidate candidate;
+            candidate.priority = priority;
+            candidate.index = i;
+            candidate.slot = base ? m_relevant.entities.size() : relevant.size();
+            candidate.bits = IDBits + measureEntity(e, base);
+            m_candidates.push_back(candidate);
+        }
+
+        if (base)
+            m_relevant.entities.push_back(*base);
+    }
+
+    for (; b != baseline->entities.end(); ++b)
+    {
+        reserved += RemovalBits;
+        client.priority.erase(b->id);
+    }
+
+    // Highest priority first, whatever doesn't fit keeps its priority and goes first next time
+    std::sort(m_candidates.begin(), m_candidates.end(), [](const Candidate& x, const Candidate& y)
+    {
+        return x.priority > y.priority || (x.priority == y.priority && x.index < y.index);
+    });
+
+    std::size_t budget = MaxDatagramSize * 8;
+    budget = budget > reserved ? budget - reserved : 0;
+    bool added = false;
+    for (const auto& candidate : m_candidates)
+    {
+        if (candidate.bits > budget)
+            continue;
+
+        budget -= candidate.bits;
+        const auto& e = snapshot.entities[candidate.index];
+        if (candidate.slot < m_relevant.entities.size())
+        {
+            m_relevant.entities[candidate.slot] = e;
+        }
+        else
+        {
+            m_relevant.entities.push_back(e);
+            added = true;
+        }
+        client.priority.erase(e.id);
+    }
+
+    if (added)
+    {
+        std::sort(m_relevant.entities.begin(), m_relevant.entities.end(),
+            [](const EntitySnapshot& x, const EntitySnapshot& y) { return x.id < y.id; });
+    }
+
+    if (client.priority.size() > relevant.size())
+        prunePriorities(client, snapshot, relevant);
+
+    BitWriter writer(m_datagram);
+    writer.write(SnapshotDatagram, 8);
+    writer.write(m_relevant.sequence, 16);
+    writer.writeBool(baseline != &NoBaseline);
+    writer.write(baseline->sequence, 16);
+    writer.writeVar(avatarID);
+
+    // Room is left for the applied input after it
+    auto& visible = client.sent[m_relevant.sequence % SnapshotHistory];
+    auto cut = writeSnapshot(writer, m_relevant, *baseline, MaxDatagramSize - 3, visible);
+    if (cut > 0 && client.snapshotsCut++ == 0)
+    {
+        LOG_WARNING("Snapshot for client {} is over {} bytes, {} entities left for later", client.id, MaxDatagramSize, cut);
+    }
+
+    // The applied input is only any use alongside where it left the avatar, so it's left out if that didn't fit
+    bool sendInput = client.hasApplied && hasCurrentState(visible, snapshot, avatarID);
+    writer.writeBool(sendInput);
+    writer.write(client.lastApplied, 16);
+
+    m_datagrams.send(m_datagram, client.address, client.port);
+
+    client.snapshotCount++;
+    client.snapshotBytes += m_datagram.size();
+    client.snapshotEntities += m_relevant.entities.size();
+}
+
+void WorldServer::prunePriorities(Client& client, const Snapshot& snapshot, const std::vector<std::size_t>& relevant)
+{
+    // Entities which left before they were ever sent, or were destroyed, would otherwise stay forever
+    for (auto p = client.priority.begin(); p != client.priority.end();)
+    {
+        auto id = p->first;
+        auto found = std::lower_bound(snapshot.entities.begin(), snapshot.entities.end(), id,
+            [](const EntitySnapshot& e, std::uint32_t i) { return e.id < i; });
+
+        auto index = static_cast<std::size_t>(found - snapshot.entities.begin());
+        if (found == snapshot.entities.end() || found->id != id || !std::binary_search(relevant.begin(), relevant.end(), index))
+            p = client.priority.erase(p);
+        else
+            ++p;
+    }
+}
+
+void WorldServer::logStats(const Client& client) const
+{
+    LOG_INFO("Client {}: {} bytes of terrain sent", client.id, client.connection.getBytesSent());
+
+    if (client.snapshotCount == 0)
+        return;
+
+    float perTick = static_cast<float>(client.snapshotBytes) / client.snapshotCount;
+    float perEntity = client.snapshotEntities > 0 ? static_cast<float>(client.snapshotBytes) / client.snapshotEntities : 0.f;
+    float relevant = static_cast<float>(client.snapshotEntities) / client.snapshotCount;
+    LOG_INFO("Client {}: {} snapshots, {} relevant entities, {} bytes per tick, {} bytes per entity per tick, {} cut short",
+        client.id, client.snapshotCount, relevant, perTick, perEntity, client.snapshotsCut);
+    LOG_INFO("Client {}: {} inputs applied, {} dropped, {} steps without one", client.id, client.inputsApplied, client.inputsDropped, client.inputsStarved);
+}
+
+std::uint64_t WorldServer::getChunkHash(sf::Vector2i index)
+{
+    if (const auto* chunk = m_terrain.getChunk(index))
+        return chunk->contentHash;
+
+    auto key = chunkKey(index);
+    auto cached = m_chunkHashes.find(key);
+    if (cached != m_chunkHashes.end())
+        return cached->second;
+
+    m_terrain.getGenerator().generate(m_scratch, index);
+    m_chunkHashes[key] = m_scratch.contentHash;
+    return m_scratch.contentHash;
+}
+
+const TerrainChunk& WorldServer::getEditedChunk(sf::Vector2i index)
+{
+    if (const auto* chunk = m_terrain.getChunk(index))
+        return *chunk;
+
+    // Built the same way TerrainRenderer::activate builds a loaded chunk, stamps then edits
+    m_terrain.getGenerator().generate(m_scratch, index);
+    m_terrain.getStamps().applyTo(m_scratch);
+    m_terrain.getEdits().applyTo(m_scratch);
+    return m_scratch;
+}
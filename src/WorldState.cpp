@@ -32,89 +32,140 @@ source distribution.
 #include <xyginext/ecs/components/Sprite.hpp>
 #include <xyginext/ecs/components/Transform.hpp>
 #include <xyginext/ecs/components/Text.hpp>
-#include <xyginext/ecs/components/CommandTarget.hpp>
 #include <xyginext/ecs/components/NetInterpolation.hpp>
 #include <xyginext/ecs/components/SpriteAnimation.hpp>
 #include <xyginext/ecs/components/AudioEmitter.hpp>
 #include <xyginext/ecs/components/Camera.hpp>
-#include <xyginext/ecs/components/QuadTreeItem.hpp>
 
 #include <xyginext/ecs/systems/SpriteRenderer.hpp>
 #include <xyginext/ecs/systems/TextRenderer.hpp>
-#include <xyginext/ecs/systems/CommandSystem.hpp>
 #include <xyginext/ecs/systems/InterpolationSystem.hpp>
 #include <xyginext/ecs/systems/SpriteAnimator.hpp>
 #include <xyginext/ecs/systems/AudioSystem.hpp>
 #include <xyginext/ecs/systems/CameraSystem.hpp>
-#include <xyginext/ecs/systems/QuadTree.hpp>
 
 #include <xyginext/graphics/SpriteSheet.hpp>
 #include <xyginext/graphics/postprocess/ChromeAb.hpp>
 
-#include <xyginext/network/NetData.hpp>
-#include <xyginext/util/Random.hpp>
 #include <xyginext/util/Vector.hpp>
 
 #include <SFML/Window/Event.hpp>
 #include <SFML/Graphics/CircleShape.hpp>
 
-#include "TerrainChunk.hpp"
-#include "TerrainRenderer.hpp"
-#include "Physics.hpp"
-#include "Velocity.hpp"
+#include <chrono>
 
 #include "Input.hpp"
-#include "Commands.hpp"
+#include "LaunchOptions.hpp"
+#include "Log.hpp"
+#include "Prediction.hpp"
+#include "Profiler.hpp"
+#include "RenderInterpolator.hpp"
+#include "TerrainRenderer.hpp"
+
+namespace
+{
+    // How often the simulation thread checks whether the render thread has taken its last snapshot
+    const std::chrono::microseconds SimulationPollInterval(250);
+}
 
-WorldState::WorldState(xy::StateStack& stack, xy::State::Context ctx)
+WorldState::WorldState(xy::StateStack& stack, xy::State::Context ctx, Preload& preload)
     : xy::State(stack, ctx),
-    m_scene(ctx.appInstance.getMessageBus()),
-    m_textures()
+    m_textures(),
+    m_client(std::move(preload.client)),
+    m_world(getLaunchOptions().pipelined ? m_worldBus : ctx.appInstance.getMessageBus(), false, m_client ? &m_client->getParams() : nullptr),
+    m_pipelined(getLaunchOptions().pipelined),
+    m_stopping(false),
+    m_finished(false),
+    m_launchTime(preload.launchTime),
+    m_drawnFirstFrame(false)
 {    
     ctx.renderWindow.setKeyRepeatEnabled(false);
+    auto& mb = m_pipelined ? m_worldBus : ctx.appInstance.getMessageBus();
 
-    // Load the player spritesheet
-    auto& sheet = m_textures.get("assets/spritesheets/roguelikeChar_transparent.png");
-    auto& font = m_fonts.get("assets/ken_fonts/kenpixel.ttf");
-
-    m_scene.addDirector<InputDirector>();
+    // Drawing only, the simulation's systems are all added by World
+    // Pipelined, the scene is never drawn itself, what it would draw is captured into snapshots instead
+    auto& scene = m_world.getScene();
+    scene.addSystem<xy::CameraSystem>(mb);
+    if (m_pipelined)
+    {
+        scene.addSystem<RenderCapture>(mb);
+        scene.addSystem<xy::SpriteAnimator>(mb);
+    }
+    else
+    {
+        scene.addSystem<xy::SpriteRenderer>(mb);
+        scene.addSystem<xy::SpriteAnimator>(mb);
+        scene.addSystem<xy::TextRenderer>(mb);
+    }
 
-    m_scene.addSystem<xy::CameraSystem>(ctx.appInstance.getMessageBus());
-    m_scene.addSystem<xy::CommandSystem>(ctx.appInstance.getMessageBus());
-    m_scene.addSystem<TerrainRenderer>(ctx.appInstance.getMessageBus());
-    m_scene.addSystem<xy::SpriteRenderer>(ctx.appInstance.getMessageBus());
-    m_scene.addSystem<xy::SpriteAnimator>(ctx.appInstance.getMessageBus());
-    m_scene.addSystem<xy::TextRenderer>(ctx.appInstance.getMessageBus());
-    m_scene.addSystem<Physics>(ctx.appInstance.getMessageBus());
+    // Decoded and generated off the main thread by LoadingState, the chunks are only used if they
+    // came from the same terrain as the world's, a playback for one picks its own seed
+    auto& terrain = scene.getSystem<TerrainRenderer>();
+    terrain.setTexture(preload.assets.getTexture(AssetPaths::TerrainSheet));
+    if (TerrainGenerator::hashParams(preload.params) == TerrainGenerator::hashParams(terrain.getGenerator().getParams()))
+    {
+        for (auto& chunk : preload.chunks)
+        {
+            terrain.adoptChunk(chunk);
+        }
+    }
+    preload.chunks.clear();
 
-    // Player entity
     xy::SpriteSheet ss;
     ss.loadFromFile("assets/spritesheets/george.spt", m_textures);
-    m_player = m_scene.createEntity();
-
-    // George is 48px tall, but our tiles are 16x16
-    m_player.addComponent<xy::Transform>().setScale(1.f / 3.f, 1.f / 3.f);
-    m_player.addComponent<xy::Sprite>() = ss.getSprite("george");
-    m_player.addComponent<xy::SpriteAnimation>();
-    m_player.addComponent<xy::CommandTarget>().ID = PlayerOne;
-
-    // Camera entity
-    auto cam = m_scene.createEntity();
-    cam.addComponent<xy::Transform>().setPosition(8, 8);
-    m_player.getComponent<xy::Transform>().addChild(cam.getComponent<xy::Transform>());
-    cam.addComponent<xy::Camera>().zoom(5.f);
-    m_scene.setActiveCamera(cam);
+    m_world.getPlayer().addComponent<xy::Sprite>() = ss.getSprite("george");
+
+    // Everything the server replicates is drawn as George for now, smoothed between snapshots
+    // The player is moved ahead of the server from local input and corrected as its positions arrive
+    if (m_client)
+    {
+        scene.addSystem<xy::InterpolationSystem>(mb);
+        m_world.getPlayer().addComponent<Predicted>();
+
+        auto george = ss.getSprite("george");
+        m_client->setSpawnCallback([george](xy::Entity entity)
+        {
+            entity.getComponent<xy::Transform>().setScale(1.f / 3.f, 1.f / 3.f);
+            entity.addComponent<xy::Sprite>() = george;
+        });
+    }
+
+    if (m_pipelined)
+    {
+        LOG_INFO("Stepping the world on its own thread");
+        m_simulationThread = std::thread(&WorldState::runSimulation, this);
+    }
+}
+
+WorldState::~WorldState()
+{
+    if (m_simulationThread.joinable())
+    {
+        m_stopping = true;
+        m_simulationThread.join();
+        m_simulationStats.logSummary("simulation updates");
+    }
 }
 
 //public
 bool WorldState::handleEvent(const sf::Event& evt)
 {
-    m_scene.forwardEvent(evt);
+    // Pipelined, only the input director is safe to hand events to, it queues them for the simulation thread
+    if (m_pipelined)
+        m_world.getInput().handleEvent(evt);
+    else
+        m_world.handleEvent(evt);
 
     if (evt.type == sf::Event::MouseWheelScrolled)
     {
         auto scroll = evt.mouseWheelScroll.delta;
-        auto& cam = m_scene.getActiveCamera().getComponent<xy::Camera>();
+        if (m_pipelined)
+        {
+            m_zoomRequests.push(scroll > 0 ? 1.1f : 0.9f);
+            return false;
+        }
+
+        auto& cam = m_world.getScene().getActiveCamera().getComponent<xy::Camera>();
         if (scroll > 0)
         {
             cam.zoom(1.1);
@@ -129,18 +180,163 @@ bool WorldState::handleEvent(const sf::Event& evt)
 
 void WorldState::handleMessage(const xy::Message& msg)
 {
-    m_scene.forwardMessage(msg);
+    // Pipelined, the world posts to and reads from its own bus on the simulation thread
+    if (m_pipelined)
+        return;
+
+    m_world.handleMessage(msg);
+
+    if (m_client)
+    {
+        m_client->handleMessage(msg);
+    }
 }
 
 bool WorldState::update(float dt)
 {
-    xy::NetEvent evt;
-    m_scene.update(dt);
+    if (m_pipelined)
+    {
+        if (m_finished)
+            xy::App::quit();
+        return false;
+    }
+
+    // xy's own systems (sprites, text, camera, commands) are the remainder of this after the markers inside it
+    PROFILE_SCOPE("Scene::update");
+    m_world.update(dt);
+
+    if (m_client)
+    {
+        m_client->update(m_world);
+    }
+
+    if (!m_world.isRunning())
+    {
+        xy::App::quit();
+    }
     return false;
 }
 
 void WorldState::draw()
 {
+    PROFILE_SCOPE("WorldState::draw");
+
+    if (m_pipelined)
+    {
+        // Keeps drawing the last snapshot if the simulation hasn't published another since
+        bool fresh = m_snapshots.acquire();
+        const auto& snapshot = m_snapshots.getReadBuffer();
+
+        auto& rw = getContext().renderWindow;
+        snapshot.draw(rw);
+        rw.setView(rw.getDefaultView());
+
+        if (fresh && snapshot.hasInput)
+        {
+            PROFILE_EVENT("Input latency", snapshot.inputTime, InputEvent::Clock::now());
+        }
+
+        // The first snapshot is published before any frame is drawn, so this one shows the world
+        if (fresh)
+            reportFirstFrame();
+        return;
+    }
+
+    // Draw between the last two steps by however far into the next one we are
+    auto& interpolator = m_world.getInterpolator();
+    interpolator.apply(m_world.getInterpolation());
+
     auto& rw = getContext().renderWindow;
-    rw.draw(m_scene);
-}
\ No newline at end of file
+    rw.draw(m_world.getScene());
+
+    interpolator.restore();
+
+    // Input latency, from the oldest event applied this frame to its drawing being submitted
+    InputEvent::Clock::time_point inputTime;
+    if (m_world.getInput().takeOldestApplied(inputTime))
+    {
+        PROFILE_EVENT("Input latency", inputTime, InputEvent::Clock::now());
+    }
+
+    reportFirstFrame();
+}
+
+//private
+void WorldState::reportFirstFrame()
+{
+    if (m_drawnFirstFrame)
+        return;
+
+    m_drawnFirstFrame = true;
+    auto now = std::chrono::steady_clock::now();
+    LOG_INFO("First interactive frame drawn {}ms after launch", std::chrono::duration<float, std::milli>(now - m_launchTime).count());
+    PROFILE_EVENT("Time to first interactive frame", m_launchTime, now);
+}
+
+void WorldState::runSimulation()
+{
+    PROFILE_THREAD_NAME("Simulation");
+
+    using Clock = std::chrono::steady_clock;
+    auto& scene = m_world.getScene();
+    auto& interpolator = m_world.getInterpolator();
+    auto last = Clock::now();
+
+    while (!m_stopping)
+    {
+        auto now = Clock::now();
+        float dt = std::chrono::duration<float>(now - last).count();
+        last = now;
+        m_simulationStats.addFrame(dt);
+
+        float zoom = 1.f;
+        while (m_zoomRequests.pop(zoom))
+        {
+            scene.getActiveCamera().getComponent<xy::Camera>().zoom(zoom);
+        }
+
+        // What the app would do for the world with its own bus, deliver what was posted last time round first
+        while (!m_worldBus.empty())
+        {
+            const auto& msg = m_worldBus.poll();
+            m_world.handleMessage(msg);
+            if (m_client)
+                m_client->handleMessage(msg);
+        }
+
+        {
+            PROFILE_SCOPE("Scene::update");
+            m_world.update(dt);
+        }
+
+        if (m_client)
+            m_client->update(m_world);
+
+        // Captured between the last two steps by however far into the next one we are, as draw() does unpipelined
+        {
+            auto& snapshot = m_snapshots.getWriteBuffer();
+            interpolator.apply(m_world.getInterpolation());
+            scene.getSystem<RenderCapture>().capture(snapshot);
+            interpolator.restore();
+
+            snapshot.hasInput = m_world.getInput().takeOldestApplied(snapshot.inputTime);
+            m_snapshots.publish();
+        }
+
+        if (!m_world.isRunning())
+        {
+            m_finished = true;
+            return;
+        }
+
+        // Nothing new to show until either the render thread has taken this snapshot or the next step is due,
+        // so the simulation runs no faster than frames are drawn but a slow frame never holds up a step
+        auto nextStep = now + std::chrono::duration_cast<Clock::duration>(
+            std::chrono::duration<float>(m_world.getTimestep() * (1.f - m_world.getInterpolation())));
+
+        while (!m_stopping && m_snapshots.isFresh() && Clock::now() < nextStep)
+        {
+            std::this_thread::sleep_for(SimulationPollInterval);
+        }
+    }
+}
@@ -26,19 +26,26 @@ source distribution.
 *********************************************************************/
 
 #include <Game.hpp>
+#include "LaunchOptions.hpp"
+#include "Log.hpp"
 
 #ifdef __linux
 #include <X11/Xlib.h>
 #endif // __linux
 
-int main()
+int main(int argc, char** argv)
 {
 #ifdef __linux
     XInitThreads();
 #endif //__linux
 
+    Log::start();
+    parseLaunchOptions(argc, argv);
+
     Game game;
     game.run();
 
+    Log::stop();
+
     return 0;
 }
\ No newline at end of file